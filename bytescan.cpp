@@ -0,0 +1,144 @@
+#include "bytescan.hpp"
+#include <cstring>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace SimpleSqlParser {
+namespace ByteScan {
+namespace {
+inline bool isWhitespace(char ch) noexcept {return ch == ' ' || (ch >= '\t' && ch <= '\r') || ch == 0;}
+
+#if defined(__AVX2__)
+typedef __m256i vec;
+constexpr size_t vecSize = 32;
+inline vec load(const char *p) noexcept {return _mm256_loadu_si256(reinterpret_cast<const vec *>(p));}
+inline vec splat(char ch) noexcept {return _mm256_set1_epi8(ch);}
+inline vec equal(vec a, vec b) noexcept {return _mm256_cmpeq_epi8(a, b);}
+inline vec either(vec a, vec b) noexcept {return _mm256_or_si256(a, b);}
+inline vec both(vec a, vec b) noexcept {return _mm256_and_si256(a, b);}
+inline vec minimum(vec a, vec b) noexcept {return _mm256_min_epu8(a, b);}
+inline vec subtract(vec a, vec b) noexcept {return _mm256_sub_epi8(a, b);}
+inline unsigned mask(vec a) noexcept {return (unsigned)_mm256_movemask_epi8(a);}
+constexpr unsigned fullMask = 0xFFFFFFFFu;
+#elif defined(__SSE2__)
+typedef __m128i vec;
+constexpr size_t vecSize = 16;
+inline vec load(const char *p) noexcept {return _mm_loadu_si128(reinterpret_cast<const vec *>(p));}
+inline vec splat(char ch) noexcept {return _mm_set1_epi8(ch);}
+inline vec equal(vec a, vec b) noexcept {return _mm_cmpeq_epi8(a, b);}
+inline vec either(vec a, vec b) noexcept {return _mm_or_si128(a, b);}
+inline vec both(vec a, vec b) noexcept {return _mm_and_si128(a, b);}
+inline vec minimum(vec a, vec b) noexcept {return _mm_min_epu8(a, b);}
+inline vec subtract(vec a, vec b) noexcept {return _mm_sub_epi8(a, b);}
+inline unsigned mask(vec a) noexcept {return (unsigned)_mm_movemask_epi8(a);}
+constexpr unsigned fullMask = 0xFFFFu;
+#endif
+}
+
+const char *skipWhitespace(const char *begin, const char *end) noexcept {
+    const char *p = begin;
+#if defined(__AVX2__) || defined(__SSE2__)
+    const vec space = splat(' '), nul = splat(0), tab = splat('\t'), range = splat('\r' - '\t');
+    for(; p + vecSize <= end; p += vecSize) {
+        const vec x = load(p), controls = subtract(x, tab); //'\t' to '\r' map to 0 to 4 (unsigned)
+        const vec whitespace = either(either(equal(x, space), equal(x, nul)), equal(minimum(controls, range), controls));
+        const unsigned m = ~mask(whitespace) & fullMask;
+        if(m) return p + __builtin_ctz(m);
+    }
+#endif
+    while(p < end && isWhitespace(*p)) p++;
+    return p;
+}
+
+const char *findCommentEnd(const char *begin, const char *end) noexcept {
+    const char *p = begin;
+#if defined(__AVX2__) || defined(__SSE2__)
+    const vec star = splat('*'), slash = splat('/');
+    for(; p + vecSize + 1 <= end; p += vecSize) {
+        const unsigned m = mask(both(equal(load(p), star), equal(load(p+1), slash)));
+        if(m) return p + __builtin_ctz(m);
+    }
+#endif
+    for(; p + 1 < end; p++) if(p[0] == '*' && p[1] == '/') return p;
+    return end;
+}
+
+const char *findEither(const char *begin, const char *end, char a, char b) noexcept {
+    const char *p = begin;
+#if defined(__AVX2__) || defined(__SSE2__)
+    const vec first = splat(a), second = splat(b);
+    for(; p + vecSize <= end; p += vecSize) {
+        const vec x = load(p);
+        const unsigned m = mask(either(equal(x, first), equal(x, second)));
+        if(m) return p + __builtin_ctz(m);
+    }
+#endif
+    for(; p < end; p++) if(*p == a || *p == b) return p;
+    return end;
+}
+
+const char *findAnyOf(const char *begin, const char *end, char a, char b, char c, char d) noexcept {
+    const char *p = begin;
+#if defined(__AVX2__) || defined(__SSE2__)
+    const vec first = splat(a), second = splat(b), third = splat(c), fourth = splat(d);
+    for(; p + vecSize <= end; p += vecSize) {
+        const vec x = load(p);
+        const unsigned m = mask(either(either(equal(x, first), equal(x, second)), either(equal(x, third), equal(x, fourth))));
+        if(m) return p + __builtin_ctz(m);
+    }
+#endif
+    for(; p < end; p++) if(*p == a || *p == b || *p == c || *p == d) return p;
+    return end;
+}
+
+const char *scanDigits(const char *begin, const char *end, uint64_t &value, bool &exact) noexcept {
+    static const uint64_t powersOf10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+    const char *p = begin;
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    //SWAR: classify and convert 8 digits at a time. The first character is the lowest byte.
+    const uint64_t zeros = 0x3030303030303030u, highNibbles = 0xF0F0F0F0F0F0F0F0u, low7 = 0x7F7F7F7F7F7F7F7Fu;
+    for(; p + 8 <= end; p += 8) {
+        uint64_t chunk; std::memcpy(&chunk, p, 8);
+        //Nonzero bytes are not digits. A carry out of a byte >= 0xFA only disturbs the bytes after it.
+        const uint64_t nondigit = ((chunk & highNibbles) ^ zeros) | (((chunk + 0x0606060606060606u) & highNibbles) ^ zeros);
+        const uint64_t flags = (((nondigit & low7) + low7) | nondigit) & ~low7; //High bit of each nonzero byte
+        const unsigned count = flags ? __builtin_ctzll(flags) >> 3 : 8;
+        if(count == 0) return p;
+        //Shift out the non-digits and pad with leading '0's, then combine digit pairs, quads and octets.
+        if(count < 8) chunk = (chunk << (8 * (8 - count))) | (zeros >> (8 * count));
+        chunk -= zeros;
+        chunk = (chunk * 10) + (chunk >> 8);
+        chunk = (((chunk & 0x000000FF000000FFu) * 0x000F424000000064u) + 
+            (((chunk >> 16) & 0x000000FF000000FFu) * 0x0000271000000001u)) >> 32;
+        if(value > (UINT64_MAX - chunk) / powersOf10[count]) exact = false;
+        value = value * powersOf10[count] + chunk;
+        if(count < 8) return p + count;
+    }
+#endif
+    for(; p < end && isDigit(*p); p++) {
+        const uint64_t digit = *p - '0';
+        if(value > (UINT64_MAX - digit) / 10) exact = false;
+        value = value * 10 + digit;
+    }
+    return p;
+}
+
+size_t countNewlines(const char *begin, const char *end, const char *&lastNewline) noexcept {
+    size_t count = 0; const char *p = begin;
+#if defined(__AVX2__) || defined(__SSE2__)
+    const vec newline = splat('\n');
+    for(; p + vecSize <= end; p += vecSize) {
+        const unsigned m = mask(equal(load(p), newline));
+        if(!m) continue;
+        count += __builtin_popcount(m);
+        lastNewline = p + (31 - __builtin_clz(m));
+    }
+#endif
+    for(; p < end; p++) if(*p == '\n') {count++; lastNewline = p;}
+    return count;
+}
+
+}}
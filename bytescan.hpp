@@ -0,0 +1,30 @@
+#ifndef __BYTESCAN__
+#define __BYTESCAN__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SimpleSqlParser {
+//Byte scanning primitives used by the lexer over its input window. Each one uses SSE2 or
+//AVX2 when the compiler targets them (e.g. -march=native) and a scalar loop otherwise.
+//None of them reads outside [begin, end).
+namespace ByteScan {
+
+//First byte in [begin, end) which is not whitespace (std::isspace in the "C" locale, or NUL); end if none.
+const char *skipWhitespace(const char *begin, const char *end) noexcept;
+//Start of the first "*/" in [begin, end); end if none.
+const char *findCommentEnd(const char *begin, const char *end) noexcept;
+//First occurrence of either a or b in [begin, end); end if none.
+const char *findEither(const char *begin, const char *end, char a, char b) noexcept;
+//First occurrence of any of a, b, c or d in [begin, end); end if none.
+const char *findAnyOf(const char *begin, const char *end, char a, char b, char c, char d) noexcept;
+inline bool isDigit(char ch) noexcept {return ch >= '0' && ch <= '9';}
+//End of the run of ASCII digits starting at begin. The digits are appended to value (value*10^n + digits);
+//exact is cleared if value overflows.
+const char *scanDigits(const char *begin, const char *end, uint64_t &value, bool &exact) noexcept;
+//Number of '\n' in [begin, end). lastNewline is set to the last one, or left unchanged if there is none.
+size_t countNewlines(const char *begin, const char *end, const char *&lastNewline) noexcept;
+
+}}
+
+#endif
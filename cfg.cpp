@@ -3,8 +3,8 @@
 
 namespace SimpleSqlParser {
 //We have put the CFG for SQL in a separate file (this).
-ParserGeneratorPhase1::ParserGeneratorPhase1() :
-    ParserGeneratorPhase1({
+const GrammarDefinition &sqlGrammarDefinition() {
+    static const GrammarDefinition definition({
         {"stmt_list", {
             {"stmt", EOSOP, "stmt_list"},
             {} //stmt_list can be empty
@@ -94,7 +94,9 @@ ParserGeneratorPhase1::ParserGeneratorPhase1() :
         {"constant", {
             {INT_CONSTANT}, {CHAR_CONSTANT}, {NUMBER_CONSTANT}
         }},
-    })
-{}
+    });
+    return definition;
+}
+ParserGeneratorPhase1::ParserGeneratorPhase1() : ParserGeneratorPhase1(sqlGrammarDefinition()) {}
 
 }
\ No newline at end of file
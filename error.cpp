@@ -25,6 +25,37 @@ std::string constructMessageStr(const Lexer::Location &loc, const char *prefix)
     return buffer.str();
 }
 
+const char *DiagnosticCodeNames[] = {"UNRECOGNIZED_CHARACTER", "UNRECOGNIZED_SEQUENCE", "EXPECTED_TOKEN", "UNEXPECTED_TOKEN"};
+
+//Diagnostic
+std::string Diagnostic::description() const {
+    switch(code) {
+    case UNRECOGNIZED_CHARACTER: 
+        return "Unrecognized character: code=" + std::to_string(lexeme[0]) + ", \'" + std::string(1, lexeme[0]) + "\'";
+    case UNRECOGNIZED_SEQUENCE: return "Unrecognized character sequence \"" + std::string(lexeme) + "\"";
+    case EXPECTED_TOKEN: 
+        return
+#ifdef DEBUG
+            std::string("Unrecoverable ") +
+#endif
+            std::string("Error; expected ") + TokenTypeNames[expected] + "; found " + std::string(lexeme) + " [" + TokenTypeNames[found] + "]";
+    case UNEXPECTED_TOKEN: return "Error; unexpected token " + std::string(lexeme) + " [" + TokenTypeNames[found] + "]";
+    }
+    return std::string();
+}
+
+//DiagnosticBuffer
+void DiagnosticBuffer::push(const Diagnostic &diagnostic) {
+    total++;
+    if(capacity == 0) return;
+    Entry *entry;
+    if(entries.size() < capacity) {entries.emplace_back(); entry = &entries.back();}
+    else {entry = &entries[oldest]; oldest = (oldest + 1) % capacity;}
+    entry->code = diagnostic.code; entry->location = diagnostic.location;
+    entry->expected = diagnostic.expected; entry->found = diagnostic.found;
+    entry->lexeme.assign(diagnostic.lexeme); //Reuses the replaced entry's storage.
+}
+
 //SyntaxError
 SyntaxError::SyntaxError(const char *what) {
     if(!what) {_what = nullptr; return;}
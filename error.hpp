@@ -3,6 +3,8 @@
 
 #include <exception>
 #include <string>
+#include <string_view>
+#include <vector>
 #include "lexer.hpp"
 
 namespace SimpleSqlParser {
@@ -10,6 +12,51 @@ namespace SimpleSqlParser {
 const char *constructMessage(const Lexer::Location &loc, const char *prefix = nullptr);
 std::string constructMessageStr(const Lexer::Location &loc, const char *prefix = nullptr);
 
+//One lexical or syntax error, as reported to a DiagnosticSink. Only the facts are recorded; the message is
+//formatted on request, so inputs with many errors cost no allocations unless the messages are wanted.
+struct Diagnostic {
+    enum Code : unsigned char {
+        UNRECOGNIZED_CHARACTER, UNRECOGNIZED_SEQUENCE, //Lexical errors; the lexeme is skipped.
+        EXPECTED_TOKEN, //The terminal on top of the stack (expected) does not match.
+        UNEXPECTED_TOKEN //The parsing table has no production for the lookahead.
+    };
+    Code code;
+    Lexer::Location location;
+    TokenType expected, found; //expected is NONE unless code is EXPECTED_TOKEN.
+    std::string_view lexeme; //Slice of the lexer's input window; only valid while the diagnostic is being reported.
+
+    std::string description() const; //Message without the location
+    std::string message() const {return constructMessageStr(location, description().c_str());} //As SyntaxError::what()
+};
+
+extern const char *DiagnosticCodeNames[];
+
+//Ring buffer of the most recent diagnostics, up to a fixed number, with copies of their lexemes so they can be
+//formatted after the input is gone. Once full, each new diagnostic replaces the oldest; dropped() counts those.
+class DiagnosticBuffer {
+    struct Entry {
+        Diagnostic::Code code;
+        Lexer::Location location;
+        TokenType expected, found;
+        std::string lexeme;
+    };
+    std::vector<Entry> entries; //Grows up to capacity, then reused in place.
+    size_t capacity, oldest, total;
+public:
+    DiagnosticBuffer(size_t capacity) : capacity(capacity), oldest(0), total(0) {}
+
+    void push(const Diagnostic &);
+    void clear() noexcept {entries.clear(); oldest = total = 0;}
+    size_t size() const noexcept {return entries.size();}
+    bool empty() const noexcept {return entries.empty();}
+    size_t dropped() const noexcept {return total - entries.size();}
+    //i-th oldest diagnostic held; its lexeme stays valid until the buffer is changed.
+    Diagnostic operator[](size_t i) const noexcept {
+        const Entry &entry = entries[(oldest + i) % entries.size()];
+        return {entry.code, entry.location, entry.expected, entry.found, entry.lexeme};
+    }
+};
+
 class SyntaxError : public std::exception {
     const char *_what;
 public:
@@ -17,6 +64,7 @@ public:
     SyntaxError(const std::string &what) : SyntaxError(what.c_str()) {}
     SyntaxError(const Lexer::Location &loc, const char *what = nullptr) : _what(constructMessage(loc, what)) {}
     SyntaxError(const Lexer::Location &loc, const std::string &what) : _what(constructMessage(loc, what.c_str())) {}
+    SyntaxError(const Diagnostic &diagnostic) : SyntaxError(diagnostic.location, diagnostic.description()) {}
     SyntaxError(const SyntaxError &other) : SyntaxError(other.what()) {}
     SyntaxError(SyntaxError &&other) noexcept : _what(other._what) {other._what = nullptr;}
     virtual ~SyntaxError() noexcept {if(_what) {delete _what; _what = nullptr;}}
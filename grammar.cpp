@@ -0,0 +1,97 @@
+#include "parsegen3.hpp"
+#include "grammar.hpp"
+#include "error.hpp"
+#include <algorithm>
+#include <iterator>
+
+namespace SimpleSqlParser {
+//Symbol
+int Symbol::compare(const Symbol &symb) const noexcept {
+    if(symbolType < symb.symbolType) return -1;
+    else if(symbolType > symb.symbolType) return 1;
+    else if(symbolType) {
+        if(symbol.nonterminalIndex < symb.symbol.nonterminalIndex) return -1;
+        else if(symbol.nonterminalIndex > symb.symbol.nonterminalIndex) return 1;
+        else return 0;
+    } else {
+        if(symbol.terminal < symb.symbol.terminal) return -1;
+        else if(symbol.terminal > symb.symbol.terminal) return 1;
+        else return 0;
+    }
+}
+
+#ifdef DEBUG
+std::string strSubRule(const std::vector<Symbol> &subRule, const std::vector<std::string> &nonterminalArray) {
+    std::string buffer;
+    if(subRule.size() < 1) return std::string("?");
+    for(size_t i = 0; i < subRule.size(); i++) {
+        buffer += (subRule[i].symbolType ? nonterminalArray[subRule[i].symbol.nonterminalIndex] : TokenTypeNames[subRule[i].symbol.terminal]);
+        if(i < (subRule.size() - 1)) buffer += " ";
+    } 
+    return buffer;
+}
+std::string strrule(const std::vector<std::vector<Symbol>> &rule, const std::vector<std::string> &nonterminalArray) {
+    std::string buffer;
+    for(size_t i = 0; i < rule.size(); i++) {
+        buffer += strSubRule(rule[i], nonterminalArray);
+        if(i < (rule.size() - 1)) buffer += " | ";
+    }
+    return buffer;
+}
+const char *ErrorRecoveryNames[] = {"POP", "SCAN"}; 
+#endif
+
+
+uint64_t grammarHash(const GrammarDefinition &definition) noexcept {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    const auto mix = [&hash](unsigned char byte) {hash = (hash ^ byte) * 0x100000001b3ull;};
+    const auto mixName = [&mix](std::string_view name) {for(char c : name) mix(c); mix(0);};
+    for(const auto &rule : definition) {
+        mixName(rule.first);
+        for(const auto &subRule : rule.second) {
+            for(const auto &symb : subRule) {
+                if(symb.nonterminal.empty()) {mix(1); mix(symb.terminal);}
+                else {mix(2); mixName(symb.nonterminal);}
+            }
+            mix(3); //End of production
+        }
+        mix(4); //End of rule
+    }
+    return hash;
+}
+
+//RuntimeGrammar
+RuntimeGrammar::RuntimeGrammar() : CompiledGrammar() {ParserGeneratorPhase3 pgp3; init(pgp3);}
+RuntimeGrammar::RuntimeGrammar(const GrammarDefinition &definition) : CompiledGrammar() {
+    ParserGeneratorPhase1 pgp1(definition); ParserGeneratorPhase2 pgp2(pgp1); ParserGeneratorPhase3 pgp3(pgp2);
+    init(pgp3);
+}
+void RuntimeGrammar::init(ParserGeneratorPhase3 &pgp3) {
+    pgp3.generateParsingTable();
+    const auto &rules = pgp3.rules;
+    std::vector<size_t> firstProduction(rules.size()); //Global index of rules[i][0]
+    for(size_t i = 0; i < rules.size(); i++) {
+        firstProduction[i] = productionStorage.size();
+        for(const auto &subRule : rules[i]) {
+            productionStorage.push_back({(uint16_t)symbolStorage.size(), (uint16_t)subRule.size()});
+            std::transform(subRule.crbegin(), subRule.crend(), std::back_inserter(symbolStorage), pack);
+        }
+    }
+    if(rules.size() > PackedSymbol::exitTag || productionStorage.size() >= errorActionBase || symbolStorage.size() > UINT16_MAX)
+        throw SyntaxError("Grammar is too large for CompiledGrammar");
+
+    tableStorage.resize(rules.size() * tokenCount);
+    for(size_t i = 0; i < rules.size(); i++) for(TokenType terminal : TokenTypes) {
+        const auto &entry = pgp3.parsingTable[i][terminal];
+        tableStorage[i * tokenCount + terminal] = entry.actionType ? 
+            (Action)(firstProduction[i] + entry.action.subRuleIndex) : errorAction(entry.action.recoveryAction);
+    }
+    nonterminalArray = pgp3.nonterminalArray;
+    for(const auto &name : nonterminalArray) nameStorage.push_back(name.c_str());
+
+    parsingTable = tableStorage.data(); productions = productionStorage.data(); symbolPool = symbolStorage.data();
+    nonterminalNames = nameStorage.data();
+    nonterminalCount = rules.size(); productionCount = productionStorage.size(); symbolCount = symbolStorage.size();
+}
+
+}
@@ -0,0 +1,143 @@
+#ifndef __GRAMMAR__
+#define __GRAMMAR__
+
+#include "lexer.hpp"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <memory>
+#include <cstdint>
+
+namespace SimpleSqlParser {
+//This needs to be hashable.
+struct Symbol {
+    union {
+        TokenType terminal;
+        size_t nonterminalIndex;
+    } symbol;
+    unsigned symbolType : 1; //1 or true value if nonterminal
+
+    int compare(const Symbol&) const noexcept;
+
+    bool operator==(const Symbol &symb) const noexcept {return compare(symb) == 0;}
+    bool operator!=(const Symbol &symb) const noexcept {return compare(symb) != 0;}
+    bool operator<(const Symbol &symb) const noexcept {return compare(symb) < 0;}
+    bool operator<=(const Symbol &symb) const noexcept {return compare(symb) <= 0;}
+    bool operator>(const Symbol &symb) const noexcept {return compare(symb) > 0;}
+    bool operator>=(const Symbol &symb) const noexcept {return compare(symb) >= 0;}
+};
+inline Symbol terminal(TokenType ttype) {Symbol s; s.symbolType = 0; s.symbol.terminal = ttype; return s;}
+inline Symbol nonterminal(size_t ntindex) {Symbol s; s.symbolType = 1; s.symbol.nonterminalIndex = ntindex; return s;}
+#ifdef DEBUG
+std::string strSubRule(const std::vector<Symbol>&, const std::vector<std::string>&);
+std::string strrule(const std::vector<std::vector<Symbol>>&, const std::vector<std::string>&);
+#endif
+
+//Symbol as written in a grammar definition (see cfg.cpp): a TokenType or the name of a nonterminal.
+struct GrammarSymbol {
+    std::string_view nonterminal; //Empty for terminals
+    TokenType terminal;
+
+    GrammarSymbol(TokenType ttype = NONE) noexcept : terminal(ttype) {}
+    GrammarSymbol(const char *nt) noexcept : nonterminal(nt), terminal(NONE) {}
+};
+
+//A grammar as written in cfg.cpp: each nonterminal with its productions. The first one is the start symbol.
+typedef std::vector<std::pair<std::string_view, std::vector<std::vector<GrammarSymbol>>>> GrammarDefinition;
+const GrammarDefinition &sqlGrammarDefinition(); //See cfg.cpp
+uint64_t grammarHash(const GrammarDefinition&) noexcept; //Stable across runs and builds (FNV-1a)
+
+//Compact Symbol for the parsing stack and the productions used by Parser: a TokenType, or a
+//nonterminal index tagged with the top bit. Trivially copyable, so productions are pushed with memcpy.
+//On the stack only, exitTag marks where an expanded nonterminal ends (see Parser::setListener).
+struct PackedSymbol {
+    static constexpr uint16_t nonterminalTag = 0x8000, exitTag = 0x4000;
+    uint16_t value;
+
+    bool isNonterminal() const noexcept {return value & nonterminalTag;}
+    bool isExitMarker() const noexcept {return (value & (nonterminalTag | exitTag)) == exitTag;}
+    size_t exitedNonterminal() const noexcept {return value & ~exitTag;}
+    TokenType terminal() const noexcept {return (TokenType)value;}
+    size_t nonterminalIndex() const noexcept {return value & ~nonterminalTag;}
+};
+inline PackedSymbol exitMarker(size_t nonterminalIndex) noexcept {return {(uint16_t)(nonterminalIndex | PackedSymbol::exitTag)};}
+inline PackedSymbol pack(const Symbol &symb) noexcept
+{return {(uint16_t)(symb.symbolType ? symb.symbol.nonterminalIndex | PackedSymbol::nonterminalTag : (size_t)symb.symbol.terminal)};}
+
+enum ErrorRecovery : unsigned char {POP, SCAN};
+#ifdef DEBUG
+extern const char *ErrorRecoveryNames[];
+#endif
+
+struct ParsingTableEntry {
+    union {
+        ErrorRecovery recoveryAction;
+        size_t subRuleIndex;
+        size_t &stackAction() noexcept {return subRuleIndex;} //type alias
+        size_t stackAction() const noexcept {return subRuleIndex;} //type alias
+    } action;
+    unsigned actionType : 1; //1 or true value if stackAction
+};
+inline ParsingTableEntry errorRecovery(ErrorRecovery action)
+{ParsingTableEntry e; e.actionType = 0; e.action.recoveryAction = action; return e;}
+inline ParsingTableEntry stackAction(size_t subRuleIndex)
+{ParsingTableEntry e; e.actionType = 1; e.action.subRuleIndex = subRuleIndex; return e;}
+
+//Flattened parsing tables used by Parser: one contiguous action table indexed nonterminal * tokenCount + token,
+//and one pool of pre-reversed productions addressed by global index. Only points to the arrays, which are
+//either generated at build time (sqlGrammar) or owned by a RuntimeGrammar/CachedGrammar. Never modified
+//once built, so one instance can be shared (see sharedSqlGrammar) by any number of Parsers and threads.
+struct CompiledGrammar {
+    typedef uint16_t Action; //Production index, or errorAction(recovery).
+    static constexpr Action errorActionBase = 0xFFFE;
+    static constexpr size_t tokenCount = EOI + 1;
+    struct Production {uint16_t offset, length;}; //Slice of symbolPool in stack push order.
+
+    const Action *parsingTable;
+    const Production *productions;
+    const PackedSymbol *symbolPool;
+    const char *const *nonterminalNames;
+    size_t nonterminalCount, productionCount, symbolCount;
+
+    static constexpr Action errorAction(ErrorRecovery recovery) noexcept {return errorActionBase + recovery;}
+    static constexpr bool isErrorAction(Action action) noexcept {return action >= errorActionBase;}
+    static constexpr ErrorRecovery recoveryOf(Action action) noexcept {return (ErrorRecovery)(action - errorActionBase);}
+
+    Action action(size_t nonterminalIndex, TokenType terminal) const noexcept
+    {return parsingTable[nonterminalIndex * tokenCount + terminal];}
+    const PackedSymbol *productionSymbols(Action action) const noexcept {return symbolPool + productions[action].offset;}
+    size_t productionLength(Action action) const noexcept {return productions[action].length;}
+};
+extern const CompiledGrammar sqlGrammar; //The grammar in cfg.cpp, generated at build time. See sqlgrammar.cpp
+//sqlGrammar for Parser. Static, so the pointer has no control block and copies of it cost no atomics.
+inline std::shared_ptr<const CompiledGrammar> sharedSqlGrammar() noexcept 
+{return std::shared_ptr<const CompiledGrammar>(std::shared_ptr<const CompiledGrammar>(), &sqlGrammar);}
+
+//CompiledGrammar generated at runtime by the ParserGenerator phases; owns the arrays it points to.
+class ParserGeneratorPhase3;
+class RuntimeGrammar : public CompiledGrammar {
+    std::vector<Action> tableStorage;
+    std::vector<Production> productionStorage;
+    std::vector<PackedSymbol> symbolStorage;
+    std::vector<std::string> nonterminalArray;
+    std::vector<const char*> nameStorage;
+
+    void init(ParserGeneratorPhase3&);
+public:
+    RuntimeGrammar(); //Grammar in cfg.cpp
+    RuntimeGrammar(const GrammarDefinition&);
+    RuntimeGrammar(ParserGeneratorPhase3 &pgp3) : CompiledGrammar() {init(pgp3);}
+    RuntimeGrammar(const RuntimeGrammar&) = delete;
+    RuntimeGrammar &operator=(const RuntimeGrammar&) = delete;
+};
+}
+
+#include <functional>
+template<> struct std::hash<SimpleSqlParser::Symbol> {
+    size_t operator()(const SimpleSqlParser::Symbol &symb) const noexcept {
+        return symb.symbolType ? symb.symbol.nonterminalIndex << 1 : ((size_t)symb.symbol.terminal << 1) + 1;
+    }
+};
+
+#endif
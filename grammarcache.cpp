@@ -0,0 +1,94 @@
+#include "grammarcache.hpp"
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <fstream>
+#include <unistd.h>
+
+namespace {
+//File layout: CacheHeader, then the action table, productions, symbol pool and the
+//NUL-terminated nonterminal names, back to back. Everything is 2-byte aligned.
+struct CacheHeader {
+    char magic[8];
+    uint32_t version, tokenCount;
+    uint64_t grammarHash, checksum; //checksum covers everything after the header.
+    uint32_t nonterminalCount, productionCount, symbolCount, namesLength;
+};
+constexpr char cacheMagic[8] = "SQLPTBL";
+constexpr uint32_t cacheVersion = 1; //Bump whenever the layout or the meaning of the tables changes.
+
+uint64_t checksum(const char *begin, const char *end) noexcept {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for(; begin != end; begin++) hash = (hash ^ (unsigned char)*begin) * 0x100000001b3ull;
+    return hash;
+}
+}
+
+namespace SimpleSqlParser {
+//CachedGrammar
+CachedGrammar::CachedGrammar(const char *path, const GrammarDefinition &definition) : CompiledGrammar() {
+    const uint64_t hash = grammarHash(definition);
+    if(load(path, hash)) return;
+    mapping.reset(); nameStorage.clear();
+    generated.reset(new RuntimeGrammar(definition));
+    CompiledGrammar::operator=(*generated);
+    save(path, *generated, hash); //Best effort; a read-only location just means no cache next time.
+}
+bool CachedGrammar::load(const char *path, uint64_t hash) {
+    mapping.reset(new MappedFile(path, false));
+    if(!mapping->isMapped() || mapping->length() < sizeof(CacheHeader)) return false;
+    CacheHeader header;
+    std::memcpy(&header, mapping->begin(), sizeof(CacheHeader));
+    if(std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 || header.version != cacheVersion ||
+        header.tokenCount != tokenCount || header.grammarHash != hash) return false;
+
+    const size_t tableLength = (size_t)header.nonterminalCount * tokenCount;
+    const char *const payload = mapping->begin() + sizeof(CacheHeader);
+    const char *const productionsBegin = payload + tableLength * sizeof(Action);
+    const char *const symbolsBegin = productionsBegin + (size_t)header.productionCount * sizeof(Production);
+    const char *const namesBegin = symbolsBegin + (size_t)header.symbolCount * sizeof(PackedSymbol);
+    if(header.nonterminalCount == 0 || header.nonterminalCount > PackedSymbol::exitTag || header.namesLength == 0 || (size_t)(mapping->end() - namesBegin) != header.namesLength) return false;
+    if(checksum(payload, mapping->end()) != header.checksum) return false;
+
+    //A matching checksum only rules out damage; still make sure nothing can index out of bounds.
+    const Action *table = reinterpret_cast<const Action *>(payload);
+    const Production *prods = reinterpret_cast<const Production *>(productionsBegin);
+    const PackedSymbol *symbols = reinterpret_cast<const PackedSymbol *>(symbolsBegin);
+    for(size_t i = 0; i < tableLength; i++) if(!isErrorAction(table[i]) && table[i] >= header.productionCount) return false;
+    for(size_t i = 0; i < header.productionCount; i++)
+        if((size_t)prods[i].offset + prods[i].length > header.symbolCount) return false;
+    for(size_t i = 0; i < header.symbolCount; i++)
+        if(symbols[i].isNonterminal() ? symbols[i].nonterminalIndex() >= header.nonterminalCount : symbols[i].value >= tokenCount) return false;
+    if(mapping->end()[-1] != '\0') return false;
+    for(const char *name = namesBegin; name != mapping->end(); name += std::strlen(name) + 1) nameStorage.push_back(name);
+    if(nameStorage.size() != header.nonterminalCount) return false;
+
+    parsingTable = table; productions = prods; symbolPool = symbols; nonterminalNames = nameStorage.data();
+    nonterminalCount = header.nonterminalCount; productionCount = header.productionCount; symbolCount = header.symbolCount;
+    return true;
+}
+bool CachedGrammar::save(const char *path, const CompiledGrammar &grammar, uint64_t hash) {
+    std::string payload;
+    payload.append(reinterpret_cast<const char *>(grammar.parsingTable), grammar.nonterminalCount * tokenCount * sizeof(Action));
+    payload.append(reinterpret_cast<const char *>(grammar.productions), grammar.productionCount * sizeof(Production));
+    payload.append(reinterpret_cast<const char *>(grammar.symbolPool), grammar.symbolCount * sizeof(PackedSymbol));
+    const size_t namesBegin = payload.size();
+    for(size_t i = 0; i < grammar.nonterminalCount; i++) {payload += grammar.nonterminalNames[i]; payload.push_back('\0');}
+
+    CacheHeader header;
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion; header.tokenCount = tokenCount;
+    header.grammarHash = hash; header.checksum = checksum(payload.data(), payload.data() + payload.size());
+    header.nonterminalCount = grammar.nonterminalCount; header.productionCount = grammar.productionCount;
+    header.symbolCount = grammar.symbolCount; header.namesLength = payload.size() - namesBegin;
+
+    //Readers either see the old file or the complete new one, even with several processes starting at once.
+    const std::string temporary = std::string(path) + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(CacheHeader));
+    out.write(payload.data(), payload.size());
+    out.close();
+    if(!out || std::rename(temporary.c_str(), path) != 0) {std::remove(temporary.c_str()); return false;}
+    return true;
+}
+}
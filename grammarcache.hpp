@@ -0,0 +1,29 @@
+#ifndef __GRAMMARCACHE__
+#define __GRAMMARCACHE__
+
+#include <memory>
+#include <vector>
+#include "grammar.hpp"
+#include "mappedfile.hpp"
+
+namespace SimpleSqlParser {
+//CompiledGrammar read straight from a memory-mapped cache file, keyed by grammarHash(definition).
+//A missing, stale (other grammar, format or token set) or corrupt cache is regenerated and rewritten.
+class CachedGrammar : public CompiledGrammar {
+    std::unique_ptr<MappedFile> mapping;
+    std::unique_ptr<RuntimeGrammar> generated; //Only when the cache could not be used
+    std::vector<const char*> nameStorage;
+
+    bool load(const char *path, uint64_t hash);
+public:
+    CachedGrammar(const char *path, const GrammarDefinition &definition = sqlGrammarDefinition());
+    CachedGrammar(const CachedGrammar&) = delete;
+    CachedGrammar &operator=(const CachedGrammar&) = delete;
+
+    bool fromCache() const noexcept {return !generated;}
+    //Writes grammar to path (atomically, through a temporary file); false on failure.
+    static bool save(const char *path, const CompiledGrammar &grammar, uint64_t hash);
+};
+}
+
+#endif
@@ -1,8 +1,14 @@
 #include <string>
 #include <utility>
 #include <cstring>
+#include <map>
+#include <limits>
+#include <algorithm>
+#include <charconv>
+#include <variant>
 #include "lexer.hpp"
 #include "error.hpp"
+#include "bytescan.hpp"
 #ifdef DEBUG 
 #include <iostream>
 #endif
@@ -29,56 +35,106 @@ const char *TokenTypeNames[] = {
     "end-of-input"
 };
 
-//DFAs
-void DFA::process(char ch) noexcept {
-    if(failed || noStateError) return;
-    else if(!isAlphabet(ch)) {failed = 1; noStateError = 1; return;}
-    currentState = transition(currentState, ch);
+//Keywords. Identifier-shaped lexemes are scanned by the Identifier machine and then looked up here
+//(case-insensitively) through a perfect hash generated at compile time from this list.
+namespace {
+constexpr uint64_t fnvOffsetBasis = 0xcbf29ce484222325ull, fnvPrime = 0x100000001b3ull; //Statement fingerprints
+
+struct Keyword {const char *name; TokenType ttype;};
+constexpr Keyword keywords[] = {
+    {"CREATE", CREATE}, {"TABLE", TABLE}, {"SELECT", SELECT}, {"INSERT", INSERT}, {"VALUES", VALUES}, {"INTO", INTO},
+    {"PRIMARY", PRIMARY}, {"KEY", KEY}, {"FROM", FROM}, {"WHERE", WHERE}, {"BETWEEN", BETWEEN}, {"LIKE", LIKE},
+    {"IN", IN}, {"AND", AND}, {"OR", OR}, {"NOT", NOT},
+    {"INT", INT}, {"INTEGER", INT}, {"CHAR", CHAR}, {"VARCHAR", CHAR},
+    {"NUMBER", NUMBER}, {"NUMERIC", NUMBER}, {"FLOAT", NUMBER}, {"DOUBLE", NUMBER},
+};
+constexpr size_t keywordCount = sizeof(keywords) / sizeof(keywords[0]);
+constexpr size_t keywordTableSize = 128; //Power of 2, sparse enough for a seed to be found quickly.
+
+//Identifier characters are letters, digits and '_'; setting bit 5 folds letters to lower case 
+//and cannot make any other identifier character equal to a letter.
+constexpr unsigned char fold(char ch) noexcept {return (unsigned char)ch | 0x20;}
+constexpr size_t keywordLength(const char *name) noexcept {size_t len = 0; while(name[len]) len++; return len;}
+constexpr size_t maxKeywordLength() noexcept {
+    size_t result = 0;
+    for(const Keyword &keyword : keywords) result = std::max(result, keywordLength(keyword.name));
+    return result;
 }
-void DFA::process(const char * const s) noexcept {for(const char *p = s; *p; p++) process(*p);}
+constexpr unsigned keywordHash(unsigned seed, const char *s, size_t len) noexcept {
+    unsigned h = seed ^ (unsigned)len;
+    for(size_t i = 0; i < len; i++) h = (h ^ fold(s[i])) * 0x01000193u; //FNV-1a step
+    return (h ^ (h >> 16)) & (keywordTableSize - 1);
+}
+constexpr unsigned findKeywordSeed() noexcept {
+    for(unsigned seed = 1; ; seed++) {
+        bool used[keywordTableSize] = {}, collision = false;
+        for(size_t i = 0; i < keywordCount && !collision; i++) {
+            const unsigned h = keywordHash(seed, keywords[i].name, keywordLength(keywords[i].name));
+            collision = used[h]; used[h] = true;
+        }
+        if(!collision) return seed;
+    }
+}
+constexpr unsigned keywordSeed = findKeywordSeed();
+struct KeywordTable {unsigned char slot[keywordTableSize];}; //Index into keywords plus one; 0 if empty.
+constexpr KeywordTable makeKeywordTable() noexcept {
+    KeywordTable table = {};
+    for(size_t i = 0; i < keywordCount; i++)
+        table.slot[keywordHash(keywordSeed, keywords[i].name, keywordLength(keywords[i].name))] = (unsigned char)(i+1);
+    return table;
+}
+constexpr KeywordTable keywordTable = makeKeywordTable();
+constexpr size_t keywordMaxLength = maxKeywordLength();
 
+//Returns the keyword token for an identifier lexeme, or IDENTIFIER.
+TokenType classifyIdentifier(std::string_view lexeme) noexcept {
+    if(lexeme.length() > keywordMaxLength) return IDENTIFIER;
+    const unsigned char slot = keywordTable.slot[keywordHash(keywordSeed, lexeme.data(), lexeme.length())];
+    if(!slot) return IDENTIFIER;
+    const Keyword &keyword = keywords[slot-1];
+    for(size_t i = 0; i < lexeme.length(); i++)
+        if(!keyword.name[i] || fold(keyword.name[i]) != fold(lexeme[i])) return IDENTIFIER;
+    return keyword.name[lexeme.length()] ? IDENTIFIER : keyword.ttype;
+}
+}
 
+//DFAs
 //DFA subclass for strings with exact matches. Not used for SQL.
-class ExactMatch : public virtual DFA {
+class ExactMatch : public DFA<ExactMatch> {
     const char * const key;
     const size_t keylen;
-protected:
+public:
     mstate transition(mstate s, char ch) noexcept {
         if(s >= keylen) {failed = 1; noStateError = 1; return s;}
         if(key[s] == ch) return s+1;
         failed = 1; return s;
     }
-public:
     ExactMatch(const char * const key, TokenType ttype = NONE) : DFA(ttype), key(key), keylen(std::strlen(key)) {
-        startState = currentState = 0;
-        acceptStates.insert({keylen});
+        acceptMask = acceptBit(keylen);
     }
     bool isAlphabet(char ch) const noexcept {return std::strchr(key, ch) ? true : false;}  //check for nonzero ptr
 };
 
 //DFA subclass for strings matching with case ignored.
-class IgnoreCaseMatch : public virtual DFA {
+class IgnoreCaseMatch : public DFA<IgnoreCaseMatch> {
     const char * const key;
     const size_t keylen;
-protected:
+public:
     mstate transition(mstate s, char ch) noexcept {
         if(s >= keylen) {failed = 1; noStateError = 1; return s;}
         if(key[s] == std::tolower(ch) || key[s] == std::toupper(ch)) return s+1;
         failed = 1; return s;
     }
-public:
     IgnoreCaseMatch(const char * const key, TokenType ttype = NONE) : DFA(ttype), key(key), keylen(std::strlen(key)) {
-        startState = currentState = 0;
-        acceptStates.insert({keylen});
+        acceptMask = acceptBit(keylen);
     }
     bool isAlphabet(char ch) const noexcept {return std::strchr(key, std::tolower(ch)) || std::strchr(key, std::toupper(ch)) ? true : false;}
 };
 
 //DFA subclass for IDENTIFIER. Regex=a(a|d)* where a=alpha or underscore,d=digit
-struct Identifier : public virtual DFA {
+struct Identifier : public DFA<Identifier> {
     Identifier() : DFA({2}, 0, IDENTIFIER) {}
     bool isAlphabet(char ch) const noexcept {return std::isdigit(ch) || std::isalpha(ch) || ch == '_';}
-protected:
     mstate transition(mstate s, char ch) noexcept {
         switch(s) {
         case 0:
@@ -92,10 +148,9 @@ protected:
 };
 
 //DFA subclass for INT_CONSTANT. Regex=(+|-|?)dd* where d=digit,?=epsilon.
-struct IntConstant : public virtual DFA {
+struct IntConstant : public DFA<IntConstant> {
     IntConstant() : DFA({0}, 1, INT_CONSTANT) {}
     bool isAlphabet(char ch) const noexcept {return ch == '+' || ch == '-' || std::isdigit(ch);}
-protected:
     mstate transition(mstate s, char ch) noexcept {
         switch(s) {
         case 0: case 3:
@@ -111,10 +166,9 @@ protected:
 };
 
 //DFA subclass for CHAR_CONSTANT. Regex='c*'|"c*" where c=any character except ' and "
-struct CharConstant : public virtual DFA {
+struct CharConstant : public DFA<CharConstant> {
     CharConstant() : DFA({2}, 0, CHAR_CONSTANT) {}
     bool isAlphabet(char) const noexcept {return true;}
-protected:
     mstate transition(mstate s, char ch) noexcept {
         switch(s) {
         case 0: //{1,4}
@@ -143,10 +197,9 @@ protected:
 };
 
 //DFA subclass for NUMBER_CONSTANT. Regex=(s|?)dd*pdd*(e(s|?)dd*|?) where s=+/-, e=literal e/E, p=literal decimal point '.', d=digit, ?=epsilon
-struct NumberConstant : public virtual DFA {
+struct NumberConstant : public DFA<NumberConstant> {
     NumberConstant() : DFA({7,8}, 0, NUMBER_CONSTANT) {}
     bool isAlphabet(char ch) const noexcept {return std::isdigit(ch) || ch == '+' || ch == '-' || ch == 'e' || ch == 'E' || ch == '.';}
-protected:
     mstate transition(mstate s, char ch) noexcept {
         switch(s) {
         case 0: //{1,2}
@@ -176,173 +229,300 @@ protected:
             else if(std::isdigit(ch)) return 7;
             else return 3;
         case 8: //{10,11}
-            if(std::isdigit(ch)) return 7;
+            if(std::isdigit(ch)) return 8;
             else {failed = 1; return 5;}
         }
         noStateError = 1; return s;
     }
 };
 
-//Lexer
-char Lexer::getChar() {
-    char ch=0; //We get a null character when src->get(ch) does not change ch.
-    if(pushback_buffer.empty()) src->get(ch);
-    else {ch = pushback_buffer.back(); pushback_buffer.pop_back();}
-    if(ch == '\n') {currentLineNumber++; currentColumnNumber = 1;}
-    else currentColumnNumber++;
-    return ch;
+//CombinedDFA
+//Machines are visited once per combined state and byte, with their transitions inlined.
+template<class Machines> CombinedDFA::CombinedDFA(std::vector<Machines> &machines) {
+    const mstate dead = std::numeric_limits<mstate>::max(); //Marks a machine which has failed.
+    std::map<std::vector<mstate>, cstate> stateIndex;
+    std::vector<std::vector<mstate>> worklist;
+    //Combined state 0 is the dead state (all machines failed), state 1 is the start state.
+    transitions.push_back({}); acceptToken.push_back(NONE);
+    std::vector<mstate> tuple;
+    for(Machines &machine : machines) std::visit([&tuple](auto &m) {m.reset(); tuple.push_back(m.getCurrentState());}, machine);
+    stateIndex.emplace(tuple, startState);
+    transitions.push_back({}); acceptToken.push_back(NONE);
+    worklist.push_back(std::move(tuple));
+    while(!worklist.empty()) {
+        const std::vector<mstate> from = std::move(worklist.back()); worklist.pop_back();
+        const cstate fromIndex = stateIndex.at(from);
+        for(unsigned byte = 0; byte < 256; byte++) {
+            std::vector<mstate> to(machines.size(), dead);
+            TokenType ttype = NONE; bool alive = false;
+            for(size_t i = 0; i < machines.size(); i++) {
+                if(from[i] == dead) continue;
+                std::visit([&](auto &machine) {
+                    machine.resume(from[i]); machine.process((char)byte);
+                    if(machine.isPermaFailed()) return;
+                    to[i] = machine.getCurrentState(); alive = true;
+                    if(machine.isAccepting() && ttype == NONE) ttype = machine.ttype; //Machines are in priority order.
+                }, machines[i]);
+            }
+            if(!alive) {transitions[fromIndex][byte] = deadState; continue;}
+            auto itr = stateIndex.find(to);
+            if(itr == stateIndex.end()) {
+                itr = stateIndex.emplace(to, (cstate)transitions.size()).first;
+                transitions.push_back({}); acceptToken.push_back(ttype);
+                worklist.push_back(to);
+            }
+            transitions[fromIndex][byte] = itr->second;
+        }
+    }
+    for(Machines &machine : machines) std::visit([](auto &m) {m.reset();}, machine);
+    transitions.shrink_to_fit(); acceptToken.shrink_to_fit();
 }
-char Lexer::peekChar() {
-    char ch=0; //We get a null character when src->get(ch) does not change ch.
-    if(pushback_buffer.empty()) {
-        src->get(ch);
-        pushback_buffer.push_back(ch);
-    } else ch = pushback_buffer.back();
-    return ch;
+
+//Lexer
+bool Lexer::fill(size_t n) {
+    if(!src) return false; //Buffer input is complete from the start.
+    //Keep everything from bufferPos onwards; move it to the front of streamBuffer.
+    const size_t kept = bufferEnd - bufferPos;
+    bufferOffset = offsetOf(bufferPos);
+    if(kept > 0 && bufferPos != streamBuffer.data()) std::memmove(streamBuffer.data(), bufferPos, kept);
+    if(streamBuffer.size() < kept + streamBlockSize || streamBuffer.size() < n) 
+        streamBuffer.resize(std::max(kept + streamBlockSize, n));
+    size_t available = kept;
+    while(available < n && src->good()) {
+        src->read(streamBuffer.data() + available, streamBuffer.size() - available);
+        available += src->gcount();
+    }
+    bufferBegin = bufferPos = streamBuffer.data(); bufferEnd = bufferBegin + available;
+    return available >= n;
 }
-void Lexer::pushback(char ch) {
-    pushback_buffer.push_back(ch);
-    if(ch == '\n') {currentLineNumber--; currentColumnNumber = 0;} //We do not know the column number in previous line.
-    else currentColumnNumber--;
+void Lexer::advance(const char *to) {
+    const char *lastNewline = nullptr;
+    currentLineNumber += ByteScan::countNewlines(bufferPos, to, lastNewline);
+    if(lastNewline) currentLineOffset = offsetOf(lastNewline)+1;
+    bufferPos = to;
 }
 void Lexer::ignoreWhitespaces() {
-    bool commentState = false;
-    while(isGood()) {
-        if(std::isspace(peekChar()) || peekChar() == 0) getChar(); //ignore whitespaces as usual
-        else if(commentState) {
-            if(peekChar() == '*') {
-                getChar(); //'*' was still on pushback_buffer. We removed it.
-                if(getChar() == '/') 
-                    commentState = false; //We are no longer in comment state
-                //Call getChar() twice because we are still in comment state.
-            } else getChar(); //Ignore
-        } else {
-            if(peekChar() == '/') {
-                getChar(); //'/' was still on pushback_buffer. We removed it.
-                if(peekChar() == '*') {
-                    getChar(); commentState = true; //We are in comment state
-                } else {
-                    pushback('/'); //Pass on slash to the lexer
-                    return; //Because this is NOT a whitespace
-                }
-            } else return; //NOT a whitespace
+    while(ensure(1)) {
+        //Most tokens are separated by a single space; only longer runs go to the vectorized skip.
+        if(*bufferPos == ' ' && bufferPos+1 != bufferEnd && bufferPos[1] > ' ' && bufferPos[1] != '/') {bufferPos++; return;}
+        advance(ByteScan::skipWhitespace(bufferPos, bufferEnd)); //ignore whitespaces as usual
+        if(bufferPos == bufferEnd) continue; //Window exhausted; try to refill.
+        if(*bufferPos != '/' || !ensure(2) || bufferPos[1] != '*') return; //NOT a whitespace; a lone slash is passed on to the lexer.
+        advance(bufferPos+2); //We are in comment state
+        while(true) {
+            const char *commentEnd = ByteScan::findCommentEnd(bufferPos, bufferEnd);
+            if(commentEnd != bufferEnd) {advance(commentEnd+2); break;} //We are no longer in comment state
+            //Not in this window. A trailing '*' may still be followed by '/' after a refill.
+            advance(bufferEnd - (bufferPos != bufferEnd && bufferEnd[-1] == '*' ? 1 : 0));
+            if(!ensure(2)) {advance(bufferEnd); return;} //Comment runs to the end of input.
         }
     }
 }
-std::vector<DFA *> Lexer::constructDFA() {
-    std::vector<DFA *> mvec; mvec.reserve(TokenTypes.size());
-    mvec.push_back(new IgnoreCaseMatch("CREATE", CREATE));
-    mvec.push_back(new IgnoreCaseMatch("TABLE", TABLE));
-    mvec.push_back(new IgnoreCaseMatch("SELECT", SELECT));
-    mvec.push_back(new IgnoreCaseMatch("INSERT", INSERT));
-    mvec.push_back(new IgnoreCaseMatch("VALUES", VALUES));
-    mvec.push_back(new IgnoreCaseMatch("INTO", INTO));
-    mvec.push_back(new IgnoreCaseMatch("PRIMARY", PRIMARY));
-    mvec.push_back(new IgnoreCaseMatch("KEY", KEY));
-    mvec.push_back(new IgnoreCaseMatch("FROM", FROM));
-    mvec.push_back(new IgnoreCaseMatch("WHERE", WHERE));
-    mvec.push_back(new IgnoreCaseMatch("BETWEEN", BETWEEN));
-    mvec.push_back(new IgnoreCaseMatch("LIKE", LIKE));
-    mvec.push_back(new IgnoreCaseMatch("IN", IN));
-    mvec.push_back(new IgnoreCaseMatch("AND", AND));
-    mvec.push_back(new IgnoreCaseMatch("OR", OR));
-    mvec.push_back(new IgnoreCaseMatch("NOT", NOT));
-    mvec.push_back(new IgnoreCaseMatch("*", STAROP));
-    mvec.push_back(new IgnoreCaseMatch("=", EQUALOP));
-    mvec.push_back(new IgnoreCaseMatch(">", GREATEROP));
-    mvec.push_back(new IgnoreCaseMatch("<", LESSOP));
-    mvec.push_back(new IgnoreCaseMatch("(", PARENOPENOP));
-    mvec.push_back(new IgnoreCaseMatch(")", PARENCLOSEOP));
-    mvec.push_back(new IgnoreCaseMatch(",", COMMAOP));
-    mvec.push_back(new IgnoreCaseMatch(";", EOSOP));
-    mvec.push_back(new IgnoreCaseMatch("INT", INT));
-    mvec.push_back(new IgnoreCaseMatch("INTEGER", INT));
-    mvec.push_back(new IgnoreCaseMatch("CHAR", CHAR));
-    mvec.push_back(new IgnoreCaseMatch("VARCHAR", CHAR));
-    mvec.push_back(new IgnoreCaseMatch("NUMBER", NUMBER));
-    mvec.push_back(new IgnoreCaseMatch("NUMERIC", NUMBER));
-    mvec.push_back(new IgnoreCaseMatch("FLOAT", NUMBER));
-    mvec.push_back(new IgnoreCaseMatch("DOUBLE", NUMBER));
-    mvec.push_back(new IntConstant);
-    mvec.push_back(new CharConstant);
-    mvec.push_back(new NumberConstant);
-    mvec.push_back(new Identifier);
+namespace {
+typedef std::variant<ExactMatch, IgnoreCaseMatch, Identifier, IntConstant, CharConstant, NumberConstant> TokenMachine;
+std::vector<TokenMachine> constructDFA() {
+    std::vector<TokenMachine> mvec; mvec.reserve(TokenTypes.size());
+    //Keywords are not machines; see classifyIdentifier.
+    mvec.emplace_back(std::in_place_type<IgnoreCaseMatch>, "*", STAROP);
+    mvec.emplace_back(std::in_place_type<IgnoreCaseMatch>, "=", EQUALOP);
+    mvec.emplace_back(std::in_place_type<IgnoreCaseMatch>, ">", GREATEROP);
+    mvec.emplace_back(std::in_place_type<IgnoreCaseMatch>, "<", LESSOP);
+    mvec.emplace_back(std::in_place_type<IgnoreCaseMatch>, "(", PARENOPENOP);
+    mvec.emplace_back(std::in_place_type<IgnoreCaseMatch>, ")", PARENCLOSEOP);
+    mvec.emplace_back(std::in_place_type<IgnoreCaseMatch>, ",", COMMAOP);
+    mvec.emplace_back(std::in_place_type<IgnoreCaseMatch>, ";", EOSOP);
+    mvec.emplace_back(std::in_place_type<IntConstant>);
+    mvec.emplace_back(std::in_place_type<CharConstant>);
+    mvec.emplace_back(std::in_place_type<NumberConstant>);
+    mvec.emplace_back(std::in_place_type<Identifier>);
     mvec.shrink_to_fit(); return mvec;
 }
-TokenType Lexer::getNextToken() {
-    DFA *targetMachine; //We have to eventually narrow it down to one machine.
-    char ch; 
-    currentToken = NONE; currentLexeme.clear();
-    //If we are not good, we are EOI.
-    if(!isGood()) {return currentToken = EOI;}
-    ignoreWhitespaces(); //Skip over whitespace.
-    currentLexemeLocation = {currentLineNumber, currentColumnNumber, 0}; //Track current location
-    //If we are not good, we are EOI.
-    if(!isGood()) {return currentToken = EOI;}
-    //Reset all DFAs and push current to all DFAs in lockstep; and
-    //find the machines which can still continue with the pushed char (noStateError is false). May be multiple.
-    ch = getChar(); currentLexeme.push_back(ch); 
-    std::vector<DFA *> currentMachines; currentMachines.reserve(machines.size());
-    size_t currentLexemeAcceptLength = 0; //Length of the substring of currentLexeme (from start position) which forms any valid token.
-    targetMachine = nullptr;
-    for(DFA *machine : machines) {
-        machine->reset(); 
-        machine->process(ch); 
-        if(machine->isAccepting() && !targetMachine) {
-            currentLexemeAcceptLength = 1; targetMachine = machine; //Possible target. No guarantee.
-            currentMachines.push_back(machine);
-        }
-        else if(!machine->isPermaFailed()) currentMachines.push_back(machine);
+}
+TokenType Lexer::reject(size_t length, bool singleCharacter) {
+    currentLexeme = std::string_view(bufferPos, length); advance(bufferPos + length); //The rejected characters are skipped.
+    const Diagnostic diagnostic{singleCharacter ? Diagnostic::UNRECOGNIZED_CHARACTER : Diagnostic::UNRECOGNIZED_SEQUENCE, 
+        currentLexemeLocation, NONE, NONE, currentLexeme};
+    if(!diagnosticSink) throw SyntaxError(diagnostic);
+    (*diagnosticSink)(diagnostic);
+    return NONE;
+}
+//CHAR_CONSTANT fast path; same language as CharConstant but found with a vectorized search for either quote.
+TokenType Lexer::scanCharConstant() {
+    const char quote = *bufferPos, otherQuote = (quote == '\'') ? '\"' : '\'';
+    size_t length = 1; //Scanned so far; the window may move while we refill.
+    while(true) {
+        const char *found = ByteScan::findEither(bufferPos + length, bufferEnd, quote, otherQuote);
+        length = found - bufferPos;
+        if(found != bufferEnd) {length++; break;}
+        if(!ensure(length+1)) return reject(length, false); //No closing quote before the end of input.
     }
-    if(currentMachines.empty()) throw SyntaxError(currentLexemeLocation, "Unrecognized character: code=" + std::to_string(ch) + ", \'" + std::string(1, ch) + "\'");
-    //Stores the machines which can still run with the character in the next iteration.
-    std::vector<DFA *> nextCurrentMachines; 
-    nextCurrentMachines.reserve(currentMachines.size());
-    //Iterate over incoming chars to create lexeme.
-    while(isGood() && !currentMachines.empty()) {
-        nextCurrentMachines.clear();
-        ch = peekChar();
-        //Push to DFAs in lockstep.
-        DFA *nextTargetMachine = nullptr;
-        for(DFA *machine : currentMachines) {
-            machine->process(ch);
-            if(machine->isAccepting() && !nextTargetMachine) {
-                nextTargetMachine = machine;
-                currentLexemeAcceptLength = currentLexeme.length()+1;
-                nextCurrentMachines.push_back(machine);
+    if(bufferPos[length-1] != quote) return reject(length, false); //The other quote may not appear in the constant.
+    currentLexeme = std::string_view(bufferPos, length); advance(bufferPos + length);
+    currentLexemeLocation.endColumnNumber = columnOf(bufferPos-1);
+    return CHAR_CONSTANT;
+}
+size_t Lexer::scanDigits(size_t from, uint64_t &value, bool &exact) {
+    while(true) {
+        const char *end = ByteScan::scanDigits(bufferPos + from, bufferEnd, value, exact);
+        from = end - bufferPos;
+        if(end != bufferEnd || !ensure(from+1)) return from;
+    }
+}
+//INT_CONSTANT/NUMBER_CONSTANT fast path: (s)?d+(.d+([eE](s)?d+)?)? in one pass, with the same longest match as
+//the IntConstant and NumberConstant machines. The value is accumulated on the way. Returns NONE if there is
+//no digit after the sign; the combined machine then deals with the lexeme.
+TokenType Lexer::scanNumber() {
+    const bool negative = *bufferPos == '-';
+    size_t length = (negative || *bufferPos == '+') ? 1 : 0;
+    if(!ensure(length+1) || !ByteScan::isDigit(bufferPos[length])) return NONE;
+    uint64_t mantissa = 0; bool exact = true; int exponent = 0;
+    TokenType ttype = INT_CONSTANT;
+    length = scanDigits(length, mantissa, exact);
+    if(ensure(length+2) && bufferPos[length] == '.' && ByteScan::isDigit(bufferPos[length+1])) {
+        ttype = NUMBER_CONSTANT;
+        const size_t fractionStart = length+1;
+        length = scanDigits(fractionStart, mantissa, exact);
+        exponent = -(int)(length - fractionStart);
+        size_t digitsStart = length+1;
+        if(ensure(length+2) && (bufferPos[length] == 'e' || bufferPos[length] == 'E')) {
+            const bool negativeExponent = bufferPos[digitsStart] == '-';
+            if(negativeExponent || bufferPos[digitsStart] == '+') digitsStart++;
+            if(ensure(digitsStart+1) && ByteScan::isDigit(bufferPos[digitsStart])) {
+                uint64_t exponentValue = 0; bool exponentExact = true;
+                length = scanDigits(digitsStart, exponentValue, exponentExact);
+                if(!exponentExact || exponentValue > 100000) exact = false; //Left to getCurrentNumberValue().
+                else exponent += negativeExponent ? -(int)exponentValue : (int)exponentValue;
             }
-            else if(!machine->isPermaFailed()) nextCurrentMachines.push_back(machine);
         }
-        if(nextTargetMachine) targetMachine = nextTargetMachine; //Another possible target.
-        currentLexeme.push_back(ch); getChar(); //advance
-        //Maybe all have rejected. which means multiple have accepted the lexeme on some previous iteration.
-        //We continue if some have still accepted the char (we display greedy behaviour)
-        std::swap(currentMachines, nextCurrentMachines); //Specialization for std::vector exists.
     }
-    //Loop breaks if currentMachines is empty or we have reached EOI. We may have found a possible target machine.
-    if(!targetMachine || currentLexemeAcceptLength == 0) throw SyntaxError(currentLexemeLocation, "Unrecognized character sequence \"" + currentLexeme + "\"");
-    //If targetMachine is found we need to push back the extra characters.
-    while(currentLexeme.length() > currentLexemeAcceptLength) {
-        pushback(currentLexeme.back()); currentLexeme.pop_back();
+    currentLexeme = std::string_view(bufferPos, length); bufferPos += length;
+    currentLexemeLocation.endColumnNumber = columnOf(bufferPos-1);
+    currentMantissa = mantissa; currentExponent = exponent; 
+    currentNegative = negative; currentValueExact = exact;
+    return ttype;
+}
+TokenType Lexer::getNextToken() {
+    const TokenType ttype = scanToken();
+    //Keywords and operators outside of constant lists, i.e. most tokens, only take one multiply.
+    constexpr uint64_t special = (1ull << INT_CONSTANT) | (1ull << CHAR_CONSTANT) | (1ull << NUMBER_CONSTANT) | 
+        (1ull << COMMAOP) | (1ull << EOSOP) | (1ull << IDENTIFIER) | (1ull << EOI);
+    static_assert(EOI < 64, "TokenType does not fit the mask");
+    if(((special >> ttype) & 1) || constantRun) fingerprint(ttype);
+    else statementHash = (statementHash ^ ttype) * fnvPrime;
+    return ttype;
+}
+void Lexer::fingerprint(TokenType ttype) noexcept {
+    switch(ttype) {
+    case INT_CONSTANT: case CHAR_CONSTANT: case NUMBER_CONSTANT:
+        if(constantRun != 2) statementHash = (statementHash ^ INT_CONSTANT) * fnvPrime; //Placeholder; the rest of a run is left out.
+        constantRun = 1; return;
+    case COMMAOP: if(constantRun == 1) {constantRun = 2; return;} break;
+    default: break;
+    }
+    if(constantRun == 2) statementHash = (statementHash ^ COMMAOP) * fnvPrime;
+    constantRun = 0;
+    if(ttype == EOSOP || (ttype == EOI && statementHash != fnvOffsetBasis)) {
+        uint64_t hash = statementHash; //Finalized (splitmix64) so that all bits depend on every token.
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull; hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+        statementFingerprint = hash ^ (hash >> 31); statementHash = fnvOffsetBasis;
+        return;
+    }
+    statementHash = (statementHash ^ ttype) * fnvPrime;
+    if(ttype == IDENTIFIER) { //8 bytes per multiply; the last word is zero padded and tagged with the length.
+        const char *p = currentLexeme.data(); size_t left = currentLexeme.length();
+        uint64_t word;
+        for(; left >= 8; p += 8, left -= 8) {std::memcpy(&word, p, 8); statementHash = (statementHash ^ word) * fnvPrime;}
+        word = (uint64_t)currentLexeme.length() << 56;
+        for(size_t i = 0; i < left; i++) word ^= (uint64_t)(unsigned char)p[i] << (8*i);
+        statementHash = (statementHash ^ word) * fnvPrime;
+    }
+}
+TokenType Lexer::scanToken() {
+    currentToken = NONE; currentLexeme = std::string_view();
+    ignoreWhitespaces(); //Skip over whitespace.
+    currentLexemeLocation = {currentLineNumber, columnOf(bufferPos), 0}; //Track current location
+    currentLexemeOffset = offsetOf(bufferPos);
+    //If there is no more input, we are EOI.
+    if(!ensure(1)) return currentToken = EOI;
+    const char first = *bufferPos;
+    if(first == '\'' || first == '\"') return currentToken = scanCharConstant();
+    if(ByteScan::isDigit(first) || first == '+' || first == '-') {
+        const TokenType ttype = scanNumber();
+        if(ttype != NONE) return currentToken = ttype;
     }
-    currentLexemeLocation.endColumnNumber = currentColumnNumber > 0 ? currentColumnNumber-1 : 0;
-    return currentToken = targetMachine->ttype;
+    //Run the combined machine over the window while it is alive (greedy behaviour).
+    CombinedDFA::cstate state = CombinedDFA::startState;
+    TokenType acceptToken = NONE; //Possible target. No guarantee.
+    size_t length = 0, acceptLength = 0; //acceptLength: length of the longest prefix which forms any valid token.
+    do {
+        state = scanner.next(state, bufferPos[length++]);
+        if(scanner.isAccepting(state)) {acceptToken = scanner.acceptToken[state]; acceptLength = length;}
+    } while(state != CombinedDFA::deadState && ensure(length+1));
+    if(acceptLength == 0) return currentToken = reject(length, length == 1 && state == CombinedDFA::deadState);
+    //Characters scanned past the accepted prefix are left in the window. Only string constants can span lines.
+    currentLexeme = std::string_view(bufferPos, acceptLength); bufferPos += acceptLength;
+    currentLexemeLocation.endColumnNumber = columnOf(bufferPos-1);
+    if(acceptToken == IDENTIFIER) acceptToken = classifyIdentifier(currentLexeme);
+    return currentToken = acceptToken;
 }
 #ifdef DEBUG
 void Lexer::showstatus() {
     std::cout<<"[LEXER: ttype="<<TokenTypeNames[currentToken]<<","<<currentLexeme<<","<<currentLineNumber
-        <<","<<currentColumnNumber<<"]\n";
+        <<","<<getCurrentColumnNumber()<<"]\n";
 } 
 #endif
-Lexer::Lexer(std::istream *src) : currentToken(NONE), src(src), currentLineNumber(1),
-    currentColumnNumber(1), machines(constructDFA()) {}
-Lexer::Lexer() : currentToken(NONE), src(nullptr), currentLineNumber(0), 
-    currentColumnNumber(0), machines(constructDFA()) {}
-Lexer::~Lexer() noexcept {for(DFA *ptr : machines) delete ptr;}
+const CombinedDFA &Lexer::combinedDFA() {
+    static const CombinedDFA dfa = [] {
+        std::vector<TokenMachine> machines(constructDFA());
+        return CombinedDFA(machines);
+    }();
+    return dfa;
+}
+Lexer::Lexer(std::istream *src) : Lexer() {reopen(src);}
+Lexer::Lexer(const char *begin, const char *end) : Lexer() {reopen(begin, end);}
+Lexer::Lexer() : currentToken(NONE), currentLexemeLocation(), currentLexemeOffset(0), src(nullptr), diagnosticSink(nullptr), bufferBegin(nullptr), bufferPos(nullptr), 
+    bufferEnd(nullptr), bufferOffset(0), currentLineNumber(0), currentLineOffset(0), 
+    currentMantissa(0), currentExponent(0), currentNegative(0), currentValueExact(1), 
+    statementHash(fnvOffsetBasis), statementFingerprint(0), constantRun(0), scanner(combinedDFA()) {}
 void Lexer::reopen(std::istream *src) {
-    currentToken = NONE; currentLexeme.clear(); currentLexemeLocation = Location();
-    this->src = src; pushback_buffer.clear(); currentLineNumber = 1; currentColumnNumber = 1;
-    for(DFA *ptr : machines) ptr->reset();
+    reopen(nullptr, nullptr);
+    this->src = src;
+}
+void Lexer::reopen(const char *begin, const char *end) {
+    currentToken = NONE; currentLexeme = std::string_view(); currentLexemeLocation = Location(); currentLexemeOffset = 0;
+    src = nullptr; bufferBegin = bufferPos = begin; bufferEnd = end; bufferOffset = 0; 
+    currentLineNumber = 1; currentLineOffset = 0;
+    statementHash = fnvOffsetBasis; statementFingerprint = 0; constantRun = 0;
+}
+void Lexer::reopen(const char *begin, const char *end, const Position &start) {
+    reopen(begin, end);
+    bufferOffset = start.offset; currentLineNumber = start.lineNumber; currentLineOffset = start.lineOffset;
+}
+int64_t Lexer::getCurrentIntValue() const noexcept {
+    const uint64_t limit = currentNegative ? (uint64_t)std::numeric_limits<int64_t>::max()+1 : std::numeric_limits<int64_t>::max();
+    const uint64_t magnitude = (currentValueExact && currentMantissa <= limit) ? currentMantissa : limit; //Saturate.
+    return currentNegative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+}
+double Lexer::getCurrentNumberValue() const noexcept {
+    static const double powersOf10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    double result;
+    //Exact (correctly rounded) when both the mantissa and the power of 10 are exact doubles.
+    if(currentValueExact && currentMantissa <= (uint64_t(1) << 53) && currentExponent >= -22 && currentExponent <= 22) {
+        result = (double)currentMantissa;
+        result = currentExponent < 0 ? result / powersOf10[-currentExponent] : result * powersOf10[currentExponent];
+    } else {
+        const char *begin = currentLexeme.data(), *end = begin + currentLexeme.length();
+        if(begin != end && (*begin == '+' || *begin == '-')) begin++; //from_chars takes no sign.
+        if(std::from_chars(begin, end, result).ec == std::errc::result_out_of_range) //Underflow or overflow
+            result = (currentLexeme.find("e-") != std::string_view::npos || currentLexeme.find("E-") != std::string_view::npos) ?
+                0.0 : std::numeric_limits<double>::infinity();
+    }
+    return currentNegative ? -result : result;
+}
+const char *Lexer::getCurrentLexeme() const {
+    currentLexemeString.assign(currentLexeme);
+    return currentLexemeString.c_str();
 }
 bool Lexer::match(TokenType mttype)  {
     if(currentToken != mttype) return false;
@@ -2,12 +2,13 @@
 #define __LEXER__
 #include <istream>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <deque>
-#include <unordered_set>
 #include <initializer_list>
 #include <array>
 #include <cctype>
+#include <cstdint>
+#include <functional>
 
 namespace SimpleSqlParser {
 typedef unsigned char ttype_parent;
@@ -28,51 +29,111 @@ extern const std::array<TokenType, EOI+1> TokenTypes;
 
 extern const char *TokenTypeNames[];
 
-class DFA {
+struct Diagnostic; //See error.hpp
+//Receives errors instead of having them thrown as SyntaxError; see Parser::parse.
+typedef std::function<void(const Diagnostic&)> DiagnosticSink;
+
+//Base of the token machines (see lexer.cpp), which are plain value types: Machine (CRTP) provides
+//isAlphabet(char) and transition(mstate, char), and process() calls them directly, so they can be inlined.
+//Accept states are a bitmask, so machines have at most maxStates states.
+template<class Machine> class DFA {
 protected:
-    std::unordered_set<mstate> acceptStates;
+    uint64_t acceptMask;
     mstate startState, currentState;
     unsigned failed : 1; //On any other error
     unsigned noStateError : 1; 
-    virtual mstate transition(mstate fromState, char ch) noexcept = 0;
+    static constexpr uint64_t acceptBit(mstate s) noexcept {return s < maxStates ? uint64_t(1) << s : 0;}
 public:
+    static constexpr mstate maxStates = 64;
     const TokenType ttype;
-    DFA(TokenType ttype = NONE) : failed(0), noStateError(0), ttype(ttype) {}
+    DFA(TokenType ttype = NONE) : acceptMask(0), startState(0), currentState(0), failed(0), noStateError(0), ttype(ttype) {}
     DFA(
-        std::initializer_list<decltype(acceptStates)::value_type> acceptStates,
+        std::initializer_list<mstate> acceptStates,
         mstate startState,
         TokenType ttype = NONE
-    ) : acceptStates(acceptStates), startState(startState), currentState(startState), failed(0), noStateError(0), ttype(ttype) {}
-    virtual ~DFA() noexcept = default;
+    ) : acceptMask(0), startState(startState), currentState(startState), failed(0), noStateError(0), ttype(ttype) 
+    {for(mstate s : acceptStates) acceptMask |= acceptBit(s);}
 
     void reset() noexcept {currentState = startState; failed = 0; noStateError = 0;}
-    virtual bool isAlphabet(char ch) const noexcept = 0;
-    void process(char ch) noexcept;
-    void process(const char * const) noexcept;
-    bool isAccepting() const noexcept {return !failed && !noStateError && acceptStates.find(currentState) != acceptStates.end();}
+    void process(char ch) noexcept {
+        if(failed || noStateError) return;
+        Machine &machine = static_cast<Machine&>(*this);
+        if(!machine.isAlphabet(ch)) {failed = 1; noStateError = 1; return;}
+        currentState = machine.transition(currentState, ch);
+    }
+    void process(const char * const s) noexcept {for(const char *p = s; *p; p++) process(*p);}
+    bool isAccepting() const noexcept {return !failed && !noStateError && (acceptMask & acceptBit(currentState));}
     bool isNoStateError() const noexcept {return noStateError ? true : false;}
     bool isPermaFailed() const noexcept {return failed || noStateError;}
+    mstate getCurrentState() const noexcept {return currentState;}
+    void resume(mstate s) noexcept {currentState = s; failed = 0; noStateError = 0;} //Continue from any live state.
+};
+
+//All token machines merged into one DFA (product construction), built once.
+//Each combined state is the tuple of states of the machines still alive; it accepts
+//with the token of the first accepting machine in TokenTypes priority order.
+struct CombinedDFA {
+    typedef unsigned short cstate;
+    static constexpr cstate deadState = 0, startState = 1;
+
+    std::vector<std::array<cstate, 256>> transitions; //Dense [state][byte] table.
+    std::vector<TokenType> acceptToken; //NONE for non-accepting states.
+
+    template<class Machines> CombinedDFA(std::vector<Machines> &machines); //std::variants of DFAs; see lexer.cpp
+    cstate next(cstate s, char ch) const noexcept {return transitions[s][(unsigned char)ch];}
+    bool isAccepting(cstate s) const noexcept {return acceptToken[s] != NONE;}
 };
 
 struct Lexer {
     struct Location {size_t lineNumber, startColumnNumber, endColumnNumber;};
+    //Where a buffer starts within a larger input: input offset, line number and input offset of that line.
+    struct Position {size_t offset, lineNumber, lineOffset;};
 private:
     TokenType currentToken;
-    std::string currentLexeme;
+    std::string_view currentLexeme; //Slice of the input window; valid until the next token is read.
+    mutable std::string currentLexemeString; //Only materialized for getCurrentLexeme().
     Location currentLexemeLocation;
-    std::istream *src;
-    
-    std::deque<char> pushback_buffer;
+    size_t currentLexemeOffset; //Input offset of the current lexeme
+    std::istream *src; //nullptr when reading from a caller-supplied buffer.
+    const DiagnosticSink *diagnosticSink; //Errors are thrown when there is none.
+
+    //Input window. For buffer input this is the whole buffer; for stream input it is
+    //streamBuffer, refilled in large blocks. Bytes from bufferPos onwards are never discarded.
+    const char *bufferBegin, *bufferPos, *bufferEnd;
+    size_t bufferOffset; //Input offset of bufferBegin.
+    std::vector<char> streamBuffer;
+    static constexpr size_t streamBlockSize = 1 << 16;
+
     decltype(Location::lineNumber) currentLineNumber;
-    decltype(Location::startColumnNumber) currentColumnNumber;
+    size_t currentLineOffset; //Input offset of the first character of the current line.
+
+    size_t offsetOf(const char *p) const noexcept {return bufferOffset + (p - bufferBegin);}
+    size_t columnOf(const char *p) const noexcept {return offsetOf(p) - currentLineOffset + 1;}
+    bool ensure(size_t n) {return (size_t)(bufferEnd - bufferPos) >= n || fill(n);} //n bytes available at bufferPos?
+    bool fill(size_t); //Read more of the stream; false at end of input.
+    void advance(const char *); //Move bufferPos forward, tracking lines.
+    void ignoreWhitespaces();
+    TokenType reject(size_t length, bool singleCharacter); //Skip an unrecognized lexeme and report it; NONE.
+    TokenType scanCharConstant();
+    size_t scanDigits(size_t from, uint64_t &value, bool &exact);
+    TokenType scanNumber();
+    TokenType scanToken();
+
+    //Value of the current numeric constant: mantissa * 10^exponent, accumulated while scanning.
+    uint64_t currentMantissa;
+    int currentExponent;
+    unsigned currentNegative : 1;
+    unsigned currentValueExact : 1; //Otherwise the value is computed from the lexeme.
 
-    bool isGood() const noexcept {return !pushback_buffer.empty() || src->good();}
-    char getChar(); char peekChar();
-    void pushback(char); //buffer overflow may happen
-    void ignoreWhitespaces();// {while(isGood() && (std::isspace(peekChar()) || peekChar()==0)) getChar();}
+    //Statement fingerprint: FNV-1a over the token types and identifier lexemes since the last ';', with each
+    //constant (or comma-separated run of constants) hashed as one placeholder.
+    uint64_t statementHash;
+    uint64_t statementFingerprint;
+    unsigned char constantRun; //1: after a constant, 2: after a constant and a ',' (not hashed yet).
+    void fingerprint(TokenType) noexcept;
 
-    const std::vector<DFA *> machines;
-    static std::vector<DFA *> constructDFA();
+    const CombinedDFA &scanner;
+    static const CombinedDFA &combinedDFA(); //Shared by all lexers.
 
 public:
     TokenType getNextToken();
@@ -80,18 +141,29 @@ public:
     void showstatus(); //Show current token status to standard output
 #endif
     Lexer(std::istream *src);
+    Lexer(const char *begin, const char *end);
     Lexer();
-    virtual ~Lexer() noexcept;
+    virtual ~Lexer() noexcept = default;
 
     TokenType getCurrentToken() const noexcept {return currentToken;}
-    const char *getCurrentLexeme() const noexcept {return currentLexeme.c_str();}
+    std::string_view getCurrentLexemeView() const noexcept {return currentLexeme;}
+    const char *getCurrentLexeme() const;
     const Location &getCurrentLexemeLocation() const noexcept {return currentLexemeLocation;}
+    size_t getCurrentLexemeOffset() const noexcept {return currentLexemeOffset;}
     size_t getCurrentLexemeLength() const noexcept {return currentLexeme.length();}
+    int64_t getCurrentIntValue() const noexcept; //For INT_CONSTANT; saturates on overflow.
+    double getCurrentNumberValue() const noexcept; //For INT_CONSTANT or NUMBER_CONSTANT.
     decltype(currentLineNumber) getCurrentLineNumber() const noexcept {return currentLineNumber;}
-    decltype(currentColumnNumber) getCurrentColumnNumber() const noexcept {return currentColumnNumber;}
+    size_t getCurrentColumnNumber() const noexcept {return columnOf(bufferPos);}
+    //Shape of the last statement ended by ';' (or by the end of input), set as soon as that token is read: the
+    //same for statements which differ only in their constants, e.g. IN (1, 2, 3) and IN (4, 5). 0 before any.
+    uint64_t getStatementFingerprint() const noexcept {return statementFingerprint;}
 
     bool match(TokenType);
+    void setDiagnosticSink(const DiagnosticSink *sink) noexcept {diagnosticSink = sink;} //nullptr: throw SyntaxError.
     void reopen(std::istream *src);
+    void reopen(const char *begin, const char *end); //Buffer must outlive the lexing.
+    void reopen(const char *begin, const char *end, const Position &start); //Locations are relative to the larger input.
 };
 }
 
@@ -1,26 +1,118 @@
 #include <iostream>
 #include <fstream>
+#include <string_view>
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdlib>
+#include <cstdint>
+#include <functional>
 #include "error.hpp"
 #include "parser.hpp"
+#include "mappedfile.hpp"
+#include "threadpool.hpp"
+#include "statementsplit.hpp"
 
-int forFile(std::istream *file, const char *fname, SimpleSqlParser::Parser *parser) {
-    int errorFlag = 0;
+size_t maxErrors = SIZE_MAX; //--max-errors N: stop reading a file after N errors
+bool jsonOutput = false; //--json: diagnostics as JSON lines
+
+void printJsonString(std::ostream &out, std::string_view str) {
+    static const char hex[] = "0123456789abcdef";
+    out<<'"';
+    for(const char ch : str) {
+        if(ch == '"' || ch == '\\') out<<'\\'<<ch;
+        else if((unsigned char)ch < 0x20) out<<"\\u00"<<hex[(unsigned char)ch >> 4]<<hex[ch & 0xF];
+        else out<<ch;
+    }
+    out<<'"';
+}
+//The message is only formatted here, when the diagnostic is printed.
+void printDiagnostic(std::ostream &out, const char *fname, const SimpleSqlParser::Diagnostic &diagnostic) {
+    if(!jsonOutput) {out<<"\nFrom "<<fname<<": "<<diagnostic.message()<<"\n"; return;}
+    out<<"{\"file\":"; printJsonString(out, fname);
+    out<<",\"line\":"<<diagnostic.location.lineNumber<<",\"startColumn\":"<<diagnostic.location.startColumnNumber
+        <<",\"endColumn\":"<<diagnostic.location.endColumnNumber<<",\"code\":\""<<SimpleSqlParser::DiagnosticCodeNames[diagnostic.code]<<'"';
+    if(diagnostic.code == SimpleSqlParser::Diagnostic::EXPECTED_TOKEN) {
+        out<<",\"expected\":"; printJsonString(out, SimpleSqlParser::TokenTypeNames[diagnostic.expected]);
+    }
+    out<<",\"found\":"; printJsonString(out, SimpleSqlParser::TokenTypeNames[diagnostic.found]);
+    out<<",\"lexeme\":"; printJsonString(out, diagnostic.lexeme);
+    out<<",\"message\":"; printJsonString(out, diagnostic.description());
+    out<<"}\n";
+}
+
+int forInput(SimpleSqlParser::Parser *parser, const SimpleSqlParser::DiagnosticSink &report) {
+    return parser->parse(report, maxErrors) ? 1 : 0;
+}
+int forFile(std::istream *file, SimpleSqlParser::Parser *parser, const SimpleSqlParser::DiagnosticSink &report) {
     parser->reopen(file);
-    while(true) {
-        try {
-            parser->continueParse();
-        } catch (SimpleSqlParser::SyntaxError &ex) {
-            errorFlag = 1;
-            std::cerr<<"\nFrom "<<fname<<": "<<ex.what()<<"\n";
-#ifdef DEBUG 
-            if(parser->unrecoverable) std::cout<<"True\n"; else std::cout<<"False\n";
-#endif
-            if(parser->unrecoverable) break;
-            continue;
+    return forInput(parser, report);
+}
+int forFile(const char *fname, SimpleSqlParser::Parser *parser, const SimpleSqlParser::DiagnosticSink &report) {
+    const SimpleSqlParser::MappedFile mapping(fname);
+    if(mapping.isMapped()) {
+        parser->reopen(mapping.begin(), mapping.end());
+        return forInput(parser, report);
+    }
+    std::ifstream file(fname); //Not a regular file; read it as a stream.
+    return forFile(&file, parser, report);
+}
+//Files of at least twice this size are also split into chunks of statements, which are parsed in parallel.
+constexpr size_t chunkSize = 4 << 20;
+
+//Parses a large file as chunks of statements on the pool. A chunk which parses without errors ends right after a
+//top-level ';' with the parser back in its initial state, so up to the first chunk with errors the result is the
+//same as parsing the file in one go. Error recovery may carry over chunk boundaries, so the file is parsed
+//sequentially from the start of that chunk on, which also reports its errors in input order.
+int forChunks(const SimpleSqlParser::MappedFile &mapping, SimpleSqlParser::WorkStealingPool &pool,
+    const std::function<SimpleSqlParser::Parser *(size_t)> &parserOf, const SimpleSqlParser::DiagnosticSink &report) {
+    const std::vector<SimpleSqlParser::StatementChunk> chunks = SimpleSqlParser::splitStatements(mapping.begin(), mapping.end(), chunkSize);
+    std::vector<int> errors(chunks.size());
+    pool.run(chunks.size(), [&](size_t worker, size_t i) {
+        SimpleSqlParser::Parser *parser = parserOf(worker);
+        parser->reopen(chunks[i].begin, chunks[i].end, chunks[i].start);
+        errors[i] = parser->parse([](const SimpleSqlParser::Diagnostic &) {}) ? 1 : 0; //Only whether there are any
+    });
+    for(size_t i = 0; i < chunks.size(); i++) if(errors[i]) {
+        SimpleSqlParser::Parser *parser = parserOf(0);
+        parser->reopen(chunks[i].begin, mapping.end(), chunks[i].start);
+        return forInput(parser, report);
+    }
+    return 0;
+}
+//Validates files on a pool of threads, one Parser per thread over the shared grammar. Diagnostics are
+//kept per file and written in argument order once all files are done. Large files are left for
+//forChunks, one at a time, so that all threads work on them.
+int forFiles(char *fnames[], size_t count, size_t threads) {
+    SimpleSqlParser::WorkStealingPool pool(threads);
+    std::vector<std::unique_ptr<SimpleSqlParser::Parser>> parsers(pool.size());
+    const auto parserOf = [&](size_t worker) {
+        if(!parsers[worker]) parsers[worker].reset(new SimpleSqlParser::Parser);
+        return parsers[worker].get();
+    };
+    std::vector<SimpleSqlParser::DiagnosticBuffer> diagnostics(count, SimpleSqlParser::DiagnosticBuffer(maxErrors));
+    std::vector<int> errors(count);
+    std::vector<std::unique_ptr<SimpleSqlParser::MappedFile>> large(count);
+    pool.run(count, [&](size_t worker, size_t i) {
+        std::unique_ptr<SimpleSqlParser::MappedFile> mapping(new SimpleSqlParser::MappedFile(fnames[i]));
+        if(mapping->isMapped() && mapping->length() >= 2 * chunkSize) {large[i] = std::move(mapping); return;}
+        const SimpleSqlParser::DiagnosticSink report = [&](const SimpleSqlParser::Diagnostic &diagnostic) {diagnostics[i].push(diagnostic);};
+        if(mapping->isMapped()) {
+            parserOf(worker)->reopen(mapping->begin(), mapping->end());
+            errors[i] = forInput(parserOf(worker), report);
         }
-        break;
+        else errors[i] = forFile(fnames[i], parserOf(worker), report);
+    });
+    for(size_t i = 0; i < count; i++) if(large[i]) {
+        errors[i] = forChunks(*large[i], pool, parserOf, [&](const SimpleSqlParser::Diagnostic &diagnostic) {diagnostics[i].push(diagnostic);});
+        large[i].reset();
+    }
+    int errorSum = 0;
+    for(size_t i = 0; i < count; i++) {
+        for(size_t j = 0; j < diagnostics[i].size(); j++) printDiagnostic(std::cerr, fnames[i], diagnostics[i][j]);
+        errorSum += errors[i];
     }
-    return errorFlag;
+    return errorSum;
 }
 
 int main(int argc, char *argv[]) {
@@ -38,14 +130,27 @@ int main(int argc, char *argv[]) {
 #endif
     int errorSum = 0;
     ++argv, --argc;
-    if(argc == 0) errorSum = forFile(&std::cin, "<standard input>", parser);
-    else {
-        std::ifstream file;
-        for(; argc > 0; ++argv, --argc) {
-            file.open(argv[0]);
-            errorSum += forFile(&file, argv[0], parser);
-            file.close();
+    size_t threads = 1; //-j N: validate files, and large files in parts, on N threads
+    for(; argc > 0 && argv[0][0] == '-'; ++argv, --argc) {
+        const std::string option(argv[0]);
+        if(option == "--json") {jsonOutput = true; continue;}
+        if(option.compare(0, 2, "-j") != 0 && option != "--max-errors") break; //Not an option; a file name.
+        const char *value = (option.compare(0, 2, "-j") == 0 && option.length() > 2) ? argv[0] + 2 : (argc > 1 ? argv[1] : "");
+        char *end; const long n = std::strtol(value, &end, 10);
+        if(*value == '\0' || *end != '\0' || n < 1) {
+            std::cerr<<"Invalid "<<(option == "--max-errors" ? "error limit for --max-errors" : "thread count for -j")<<": \""<<value<<"\"\n";
+            delete parser; return 1;
         }
+        if(value == argv[1]) ++argv, --argc;
+        if(option == "--max-errors") maxErrors = n; else threads = n;
+    }
+    if(argc == 0) {
+        std::ios::sync_with_stdio(false); //Let std::cin buffer, so the lexer can read it in large blocks.
+        errorSum = forFile(&std::cin, parser, [](const SimpleSqlParser::Diagnostic &diagnostic) 
+            {printDiagnostic(std::cerr, "<standard input>", diagnostic);});
     }
+    else if(threads > 1) errorSum = forFiles(argv, argc, threads);
+    else for(; argc > 0; ++argv, --argc) 
+        errorSum += forFile(argv[0], parser, [&](const SimpleSqlParser::Diagnostic &diagnostic) {printDiagnostic(std::cerr, argv[0], diagnostic);});
     delete parser; return errorSum;
 }
\ No newline at end of file
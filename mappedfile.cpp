@@ -0,0 +1,29 @@
+#include "mappedfile.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace SimpleSqlParser {
+//MappedFile
+MappedFile::MappedFile(const char *path, bool sequential) : data(nullptr), size(0), mapped(false) {
+    static const char empty[1] = {0};
+    const int fd = open(path, O_RDONLY);
+    if(fd < 0) return;
+    struct stat info;
+    if(fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        if(info.st_size == 0) {data = empty; mapped = true;} //Cannot map zero bytes.
+        else {
+            void *ptr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(ptr != MAP_FAILED) {
+                if(sequential) madvise(ptr, info.st_size, MADV_SEQUENTIAL);
+                data = static_cast<const char *>(ptr); size = info.st_size; mapped = true;
+            }
+        }
+    }
+    close(fd); //The mapping stays valid.
+}
+MappedFile::~MappedFile() noexcept {
+    if(mapped && size > 0) munmap(const_cast<char *>(data), size);
+}
+}
@@ -0,0 +1,26 @@
+#ifndef __MAPPEDFILE__
+#define __MAPPEDFILE__
+
+#include <cstddef>
+
+namespace SimpleSqlParser {
+//Read-only memory mapping of a whole regular file. Mapping fails (isMapped() is false) for 
+//anything else, such as pipes or terminals; those should be read as a stream instead.
+class MappedFile {
+    const char *data;
+    size_t size;
+    unsigned mapped : 1;
+public:
+    MappedFile(const char *path, bool sequential = true); //sequential: advise the kernel to read ahead.
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile() noexcept;
+
+    bool isMapped() const noexcept {return mapped;}
+    const char *begin() const noexcept {return data;}
+    const char *end() const noexcept {return data + size;}
+    size_t length() const noexcept {return size;}
+};
+}
+
+#endif
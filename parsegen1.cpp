@@ -5,19 +5,20 @@
 
 #ifdef DEBUG
 namespace {//Declarations private to this file.
-std::string _strSubRule(const std::vector<SimpleSqlParser::ParserGeneratorPhase1::IntermediateSymbol> &subRule) {
+using SimpleSqlParser::ParserGeneratorPhase1;
+std::string _strSubRule(const std::vector<ParserGeneratorPhase1::IntermediateSymbol> &subRule, const SimpleSqlParser::NonterminalInterner &nonterminals) {
     std::string buffer;
     if(subRule.size() < 1) return std::string("?");
     for(size_t i = 0; i < subRule.size(); i++) {
-        buffer += (subRule[i].symbolType ? *(subRule[i].symbol.nonterminal) : SimpleSqlParser::TokenTypeNames[subRule[i].symbol.terminal]);
+        buffer += (subRule[i].symbolType ? nonterminals.name(subRule[i].symbol.nonterminalIndex) : SimpleSqlParser::TokenTypeNames[subRule[i].symbol.terminal]);
         if(i < (subRule.size() - 1)) buffer += " ";
     } 
     return buffer;
 }
-std::string _strrule(const std::vector<std::vector<SimpleSqlParser::ParserGeneratorPhase1::IntermediateSymbol>> &rule) {
+std::string _strrule(const std::vector<std::vector<ParserGeneratorPhase1::IntermediateSymbol>> &rule, const SimpleSqlParser::NonterminalInterner &nonterminals) {
     std::string buffer;
     for(size_t i = 0; i < rule.size(); i++) {
-        buffer += _strSubRule(rule[i]);
+        buffer += _strSubRule(rule[i], nonterminals);
         if(i < (rule.size() - 1)) buffer += " | ";
     }
     return buffer;
@@ -26,92 +27,40 @@ std::string _strrule(const std::vector<std::vector<SimpleSqlParser::ParserGenera
 
 
 namespace SimpleSqlParser {
-//ParserGeneratorPhase1
-ParserGeneratorPhase1::IntermediateSymbol::IntermediateSymbol(const IntermediateSymbol &symb) {
-    symbolType = symb.symbolType;
-    if(symbolType) symbol.nonterminal = new std::string(*symb.symbol.nonterminal);
-    else symbol.terminal = symb.symbol.terminal;
-}
-ParserGeneratorPhase1::IntermediateSymbol::IntermediateSymbol(IntermediateSymbol&& symb) noexcept {
-    symbolType = symb.symbolType;
-    if(symbolType) {
-        symbol.nonterminal = symb.symbol.nonterminal;
-        symb.symbol.nonterminal = nullptr;
-        symb.symbol.terminal = NONE;
-        symb.symbolType = 0;
-    }
-    else symbol.terminal = symb.symbol.terminal;
-}
-ParserGeneratorPhase1::IntermediateSymbol::~IntermediateSymbol() noexcept {
-    if(symbolType && symbol.nonterminal) delete symbol.nonterminal;
-    symbol.nonterminal = nullptr;
-}
-ParserGeneratorPhase1::IntermediateSymbol& ParserGeneratorPhase1::IntermediateSymbol::operator=(const IntermediateSymbol &symb) {
-    if(symbolType && symbol.nonterminal) delete symbol.nonterminal;
-    symbolType = symb.symbolType;
-    if(symbolType) symbol.nonterminal = new std::string(*symb.symbol.nonterminal);
-    else symbol.terminal = symb.symbol.terminal;
-    return *this;
-}
-ParserGeneratorPhase1::IntermediateSymbol& ParserGeneratorPhase1::IntermediateSymbol::operator=(const std::string &nonterminal) {
-    if(symbolType && symbol.nonterminal) delete symbol.nonterminal;
-    symbolType = 1;
-    symbol.nonterminal = new std::string(nonterminal);
-    return *this;
-}
-ParserGeneratorPhase1::IntermediateSymbol& ParserGeneratorPhase1::IntermediateSymbol::operator=(TokenType terminal) noexcept {
-    if(symbolType && symbol.nonterminal) delete symbol.nonterminal;
-    symbolType = 0;
-    symbol.terminal = terminal;
-    return *this;
-}
-ParserGeneratorPhase1::IntermediateSymbol& ParserGeneratorPhase1::IntermediateSymbol::operator=(IntermediateSymbol&& symb) noexcept {
-    if(symbolType && symbol.nonterminal) delete symbol.nonterminal;
-    symbolType = symb.symbolType;
-    if(symbolType) {
-        symbol.nonterminal = symb.symbol.nonterminal;
-        symb.symbol.nonterminal = nullptr;
-        symb.symbol.terminal = NONE;
-        symb.symbolType = 0;
-    }
-    else symbol.terminal = symb.symbol.terminal;
-    return *this;
-}
-int ParserGeneratorPhase1::IntermediateSymbol::compare(const IntermediateSymbol& symb) const noexcept {
-    if(symbolType < symb.symbolType) return -1;
-    else if(symbolType > symb.symbolType) return 1;
-    else if(symbolType) return symbol.nonterminal->compare(*symb.symbol.nonterminal);
-    else {
-        if(symbol.terminal < symb.symbol.terminal) return -1;
-        else if(symbol.terminal > symb.symbol.terminal) return 1;
-        else return 0;
-    }
+//NonterminalInterner
+size_t NonterminalInterner::intern(std::string_view name) {
+    auto itr = ids.find(name);
+    if(itr != ids.end()) return itr->second;
+    names.emplace_back(name);
+    ids.emplace(names.back(), names.size() - 1);
+    return names.size() - 1;
 }
 
+//ParserGeneratorPhase1
 #ifdef DEBUG 
 void ParserGeneratorPhase1::outputRules() {
     for(size_t i = 0; i < nonterminalArray.size(); i++)
-        std::cout<<nonterminalArray[i]<<" ::= "<<_strrule(rules[i])<<std::endl;
+        std::cout<<nonterminals.name(nonterminalArray[i])<<" ::= "<<_strrule(rules[i], nonterminals)<<std::endl;
 }
 #endif
+size_t ParserGeneratorPhase1::newNonterminal(size_t nonterminal, const char *suffix) {
+    std::string name; size_t nameGen = 1;
+    do {
+        name = nonterminals.name(nonterminal) + suffix + std::to_string(nameGen); nameGen++;
+    } while(nonterminals.contains(name));
+    return nonterminals.intern(name);
+}
 
-//IntermediateSymbolHash
-std::hash<std::string> ParserGeneratorPhase1::IntermediateSymbolHash::hashObject;
-
-std::pair<std::string, std::vector<std::vector<ParserGeneratorPhase1::IntermediateSymbol>>>
+std::pair<size_t, std::vector<std::vector<ParserGeneratorPhase1::IntermediateSymbol>>>
 ParserGeneratorPhase1::removeLeftRecursion(size_t nonterminalIndex) {
-    const std::string &nonterminal = nonterminalArray[nonterminalIndex];
-    std::string newNonterminal; size_t nameGen = 1;
-    do {
-        newNonterminal = nonterminal + "_r" + std::to_string(nameGen); nameGen++;
-    } while (std::find(nonterminalArray.cbegin(), nonterminalArray.cend(), newNonterminal) != nonterminalArray.cend());
+    const size_t nonterminal = nonterminalArray[nonterminalIndex];
 #ifdef DEBUG
-    std::cout<<"\nRemoving immediate-left recursion for "<<nonterminal<<". New nonterminal will be "<<newNonterminal<<".\n";
+    std::cout<<"\nRemoving immediate-left recursion for "<<nonterminals.name(nonterminal)<<".\n";
 #endif
     std::vector<std::vector<IntermediateSymbol>> leftRecursionRule, nonLeftRecursionRule, newRule, newRule2;
     std::vector<std::vector<IntermediateSymbol>> &rule = rules[nonterminalIndex];
     for(auto &subRule : rule) {
-        if(!(subRule.size() > 0 && subRule[0] == nonterminal)) continue;
+        if(!(subRule.size() > 0 && subRule[0] == SimpleSqlParser::nonterminal(nonterminal))) continue;
         leftRecursionRule.push_back(subRule);
     }
     if(leftRecursionRule.size() < 1) {
@@ -120,9 +69,13 @@ ParserGeneratorPhase1::removeLeftRecursion(size_t nonterminalIndex) {
 #endif
         return {}; //Calls default ctor
     }
+    const size_t newNonterminal = this->newNonterminal(nonterminal, "_r");
+#ifdef DEBUG
+    std::cout<<"New nonterminal will be "<<nonterminals.name(newNonterminal)<<".\n";
+#endif
     SetUtil::setify(leftRecursionRule);
     nonLeftRecursionRule = SetUtil::difference(rule, leftRecursionRule);
-    const std::vector<IntermediateSymbol> singleton({newNonterminal});
+    const std::vector<IntermediateSymbol> singleton({SimpleSqlParser::nonterminal(newNonterminal)});
     for(auto& subRule: nonLeftRecursionRule) newRule.push_back(SetUtil::addVectors(subRule, singleton));
     SetUtil::setify(newRule); rules[nonterminalIndex] = newRule;
     for(auto& subRule: leftRecursionRule) newRule2.push_back(SetUtil::addVectors<IntermediateSymbol>(subRule.cbegin()+1, subRule.cend(), singleton.cbegin(), singleton.cend()));
@@ -130,36 +83,36 @@ ParserGeneratorPhase1::removeLeftRecursion(size_t nonterminalIndex) {
     SetUtil::setify(newRule2); 
 #ifdef DEBUG
     std::cout<<"New rules:\n";
-    std::cout<<nonterminal<<" ::= "<<_strrule(newRule)<<std::endl;
-    std::cout<<newNonterminal<<" ::= "<<_strrule(newRule2)<<std::endl;
+    std::cout<<nonterminals.name(nonterminal)<<" ::= "<<_strrule(newRule, nonterminals)<<std::endl;
+    std::cout<<nonterminals.name(newNonterminal)<<" ::= "<<_strrule(newRule2, nonterminals)<<std::endl;
 #endif
     return {newNonterminal, newRule2};
 }
 void ParserGeneratorPhase1::removeLeftRecursion() {
     if(leftRecursionRemovalDone) return;
-    std::unordered_map<size_t, std::pair<std::string, std::vector<std::vector<IntermediateSymbol>>>> newNonterminals; 
+    std::unordered_map<size_t, std::pair<size_t, std::vector<std::vector<IntermediateSymbol>>>> newNonterminals; 
     for(size_t i = 0; i < nonterminalArray.size(); i++) {
 #ifdef DEBUG
-        std::cout<<"\nRemoving chained-left recursion for "<<nonterminalArray[i]<<std::endl;
+        std::cout<<"\nRemoving chained-left recursion for "<<nonterminals.name(nonterminalArray[i])<<std::endl;
 #endif
         for(size_t j = 0; j < i; j++) {
 #ifdef DEBUG
-            std::cout<<"Trying substituting in "<<nonterminalArray[j]<<std::endl;
+            std::cout<<"Trying substituting in "<<nonterminals.name(nonterminalArray[j])<<std::endl;
 #endif
             std::vector<std::vector<IntermediateSymbol>> newRuleSet;
             for(auto& subRule : rules[i])
-                if(subRule.size() > 0 && subRule[0] == nonterminalArray[j])
+                if(subRule.size() > 0 && subRule[0] == nonterminal(nonterminalArray[j]))
                     for(auto& jSubRule : rules[j])
                         newRuleSet.push_back(SetUtil::addVectors<IntermediateSymbol>(jSubRule.cbegin(), jSubRule.cend(), subRule.cbegin()+1, subRule.cend()));
                 else newRuleSet.push_back(subRule);
             SetUtil::setify(newRuleSet);
             rules[i] = newRuleSet;
 #ifdef DEBUG
-            std::cout<<nonterminalArray[i]<<" ::= "<<_strrule(newRuleSet)<<std::endl;
+            std::cout<<nonterminals.name(nonterminalArray[i])<<" ::= "<<_strrule(newRuleSet, nonterminals)<<std::endl;
 #endif
         }
         const auto newNonterminal = removeLeftRecursion(i);
-        if(newNonterminal.first.size() > 0)
+        if(newNonterminal.second.size() > 0)
             newNonterminals[i] = newNonterminal; //Insert newNonterminal after index i
     }
 
@@ -179,17 +132,13 @@ void ParserGeneratorPhase1::removeLeftRecursion() {
     //Do not shrink. Phase not complete.
     leftRecursionRemovalDone = true;
 }
-std::pair<std::string, std::vector<std::vector<ParserGeneratorPhase1::IntermediateSymbol>>>
+std::pair<size_t, std::vector<std::vector<ParserGeneratorPhase1::IntermediateSymbol>>>
 ParserGeneratorPhase1::leftFactoring(size_t nonterminalIndex) {
-    const std::string &nonterminal = nonterminalArray[nonterminalIndex];
-    std::string newNonterminal; size_t nameGen = 1;
+    const size_t nonterminal = nonterminalArray[nonterminalIndex];
     std::vector<std::vector<IntermediateSymbol>> &rule = rules[nonterminalIndex], 
         leftFactoringRule, nonLeftFactoringRule, ruleSet1, ruleSet2;
-    do {
-        newNonterminal = nonterminal + "_f" + std::to_string(nameGen); nameGen++;
-    } while(std::find(nonterminalArray.cbegin(), nonterminalArray.cend(), newNonterminal) != nonterminalArray.cend());
 #ifdef DEBUG 
-    std::cout<<"\nPerforming left-factoring for "<<nonterminal<<". New nonterminal will be "<<newNonterminal<<".\n";
+    std::cout<<"\nPerforming left-factoring for "<<nonterminals.name(nonterminal)<<".\n";
 #endif
     std::vector<IntermediateSymbol> longestCommonSubsequence;
     for(size_t i = 0; i < rule.size(); i++) {
@@ -208,13 +157,17 @@ ParserGeneratorPhase1::leftFactoring(size_t nonterminalIndex) {
 #endif
         return {};
     }
+    const size_t newNonterminal = this->newNonterminal(nonterminal, "_f");
+#ifdef DEBUG 
+    std::cout<<"New nonterminal will be "<<nonterminals.name(newNonterminal)<<".\n";
+#endif
 
     for(auto& subRule : rule)
         if(SetUtil::begins_with(subRule, longestCommonSubsequence)) leftFactoringRule.push_back(subRule);
     SetUtil::setify(leftFactoringRule);
     nonLeftFactoringRule = SetUtil::difference(rule, leftFactoringRule);
 
-    ruleSet1 = nonLeftFactoringRule; ruleSet1.push_back(SetUtil::addVectors(longestCommonSubsequence, std::vector<IntermediateSymbol>({newNonterminal})));
+    ruleSet1 = nonLeftFactoringRule; ruleSet1.push_back(SetUtil::addVectors(longestCommonSubsequence, std::vector<IntermediateSymbol>({SimpleSqlParser::nonterminal(newNonterminal)})));
     SetUtil::setify(ruleSet1); rules[nonterminalIndex] = ruleSet1;
 
     for(auto& subRule : leftFactoringRule) {
@@ -224,10 +177,10 @@ ParserGeneratorPhase1::leftFactoring(size_t nonterminalIndex) {
     } SetUtil::setify(ruleSet2);
 
 #ifdef DEBUG
-    std::cout<<"Longest common subsequence selected: "<<_strSubRule(longestCommonSubsequence)<<std::endl;
+    std::cout<<"Longest common subsequence selected: "<<_strSubRule(longestCommonSubsequence, nonterminals)<<std::endl;
     std::cout<<"\nNew rules:\n";
-    std::cout<<nonterminal<<" ::= "<<_strrule(ruleSet1)<<std::endl;
-    std::cout<<newNonterminal<<" ::= "<<_strrule(ruleSet2)<<std::endl;
+    std::cout<<nonterminals.name(nonterminal)<<" ::= "<<_strrule(ruleSet1, nonterminals)<<std::endl;
+    std::cout<<nonterminals.name(newNonterminal)<<" ::= "<<_strrule(ruleSet2, nonterminals)<<std::endl;
 #endif
 
     return {newNonterminal, ruleSet2};
@@ -244,9 +197,8 @@ void ParserGeneratorPhase1::leftFactoring() {
 #ifdef DEBUG
         run++; std::cout<<"\nRun "<<run<<std::endl;
 #endif
-        std::unordered_map<size_t, std::pair<std::string, std::vector<std::vector<IntermediateSymbol>>>> newNonterminals; 
+        std::unordered_map<size_t, std::pair<size_t, std::vector<std::vector<IntermediateSymbol>>>> newNonterminals; 
         for(size_t i = 0; i < nonterminalArray.size(); i++) {
-            //const std::string &nonterminal = nonterminalArray[i];
             const auto newNonterminal = leftFactoring(i);
             if(newNonterminal.second.size() > 0) {
                 newNonterminals[i] = newNonterminal;
@@ -270,11 +222,17 @@ void ParserGeneratorPhase1::leftFactoring() {
     nonterminalArray.shrink_to_fit(); rules.shrink_to_fit();
     leftFactoringDone = true;
 }
-ParserGeneratorPhase1::ParserGeneratorPhase1(std::initializer_list<std::pair<std::string, std::vector<std::vector<IntermediateSymbol>>>> cfg) 
+ParserGeneratorPhase1::ParserGeneratorPhase1(const GrammarDefinition &cfg) 
 : leftRecursionRemovalDone(false), leftFactoringDone(false) {
+    for(auto &rule : cfg) nonterminalArray.push_back(nonterminals.intern(rule.first)); //Defined nonterminals get IDs in order
     for(auto &rule : cfg) {
-        nonterminalArray.push_back(rule.first);
-        rules.push_back(rule.second);
+        rules.emplace_back();
+        for(auto &subRule : rule.second) {
+            rules.back().emplace_back(subRule.size());
+            std::transform(subRule.begin(), subRule.end(), rules.back().back().begin(), [&](const GrammarSymbol &gsymb) {
+                return gsymb.nonterminal.empty() ? terminal(gsymb.terminal) : nonterminal(nonterminals.intern(gsymb.nonterminal));
+            });
+        }
         SetUtil::setify(rules.back());
     }
 }}
@@ -2,84 +2,63 @@
 #ifndef __PARSEGEN1__
 #define __PARSEGEN1__
 
-#include <initializer_list>
 #include <vector>
 #include <string>
 #include <utility>
-#include <functional>
-#include "parser.hpp"
+#include <deque>
+#include <unordered_map>
+#include <string_view>
+#include "grammar.hpp"
 #ifdef DEBUG 
 #include <iostream>
 #endif
 
 namespace SimpleSqlParser {
+//Nonterminal names seen by the parser generator. Each name is stored once and nonterminals are referred to
+//by their ID (index) everywhere else; names live in a deque so the views used as map keys stay valid.
+class NonterminalInterner {
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, size_t> ids;
+public:
+    size_t intern(std::string_view);
+    bool contains(std::string_view name) const {return ids.find(name) != ids.end();}
+    const std::string &name(size_t id) const noexcept {return names[id];}
+    size_t size() const noexcept {return names.size();}
+};
+
 class ParserGeneratorPhase2; //Forward declaration required. see parsegen2.hpp
 //Factory class for Parser; phase 1: left-recursion removal and left-factoring (rules may change)
 class ParserGeneratorPhase1 {
 #ifdef DEBUG 
 public: //The following becomes implicitly public.
 #endif
-    //Master nonterminal array, of which is NOT SORTED
-    std::vector<std::string> nonterminalArray;
+    NonterminalInterner nonterminals;
+    //Master nonterminal array (interned IDs), of which is NOT SORTED
+    std::vector<size_t> nonterminalArray;
     
-    //This also needs to be hashable.
-    struct IntermediateSymbol {
-        union {
-            TokenType terminal;
-            std::string *nonterminal;
-        } symbol;
-        unsigned symbolType : 1; //1 or true value if nonterminal
-
-        IntermediateSymbol(TokenType ttype = NONE) noexcept : symbolType(0) {symbol.terminal = ttype;}
-        IntermediateSymbol(const std::string &nt) : symbolType(1) {symbol.nonterminal = new std::string(nt);}
-        IntermediateSymbol(const char *nt) : symbolType(1) {symbol.nonterminal = new std::string(nt);}
-        IntermediateSymbol(const IntermediateSymbol&);
-        IntermediateSymbol(IntermediateSymbol&&) noexcept;
-        ~IntermediateSymbol() noexcept;
-
-        IntermediateSymbol& operator=(const IntermediateSymbol&);
-        IntermediateSymbol& operator=(const std::string&);
-        IntermediateSymbol& operator=(TokenType) noexcept;
-        IntermediateSymbol& operator=(IntermediateSymbol&&) noexcept;
-        
-        int compare(const IntermediateSymbol&) const noexcept;
-
-        bool operator==(const IntermediateSymbol &symb) const noexcept {return compare(symb) == 0;}
-        bool operator!=(const IntermediateSymbol &symb) const noexcept {return compare(symb) != 0;}
-        bool operator==(const std::string &nonterminal) const noexcept {return symbolType && *symbol.nonterminal == nonterminal;}
-        bool operator==(TokenType ttype) const noexcept {return !symbolType && symbol.terminal == ttype;}
-
-        bool operator<(const IntermediateSymbol &symb) const noexcept {return compare(symb) < 0;}
-        bool operator<=(const IntermediateSymbol &symb) const noexcept {return compare(symb) <= 0;}
-        bool operator>(const IntermediateSymbol &symb) const noexcept {return compare(symb) > 0;}
-        bool operator>=(const IntermediateSymbol &symb) const noexcept {return compare(symb) >= 0;}
-    };
+    //Symbol whose nonterminalIndex is an interned ID. Trivially copyable.
+    typedef Symbol IntermediateSymbol;
 #ifdef DEBUG 
     void outputRules();
 #endif
 
-    struct IntermediateSymbolHash {
-        static std::hash<std::string> hashObject;
-        constexpr size_t operator()(const IntermediateSymbol &symb) const noexcept {
-            return symb.symbolType ? 
-                hashObject(*(symb.symbol.nonterminal)) << 1 : (((size_t)symb.symbol.terminal) << 1) + 1;
-        }
-    };
-
     std::vector<std::vector<std::vector<IntermediateSymbol>>> rules;
 
-    std::pair<std::string, std::vector<std::vector<IntermediateSymbol>>> removeLeftRecursion(size_t);
+    //The following return an empty rule if there is nothing to do; otherwise the new nonterminal and its rule.
+    std::pair<size_t, std::vector<std::vector<IntermediateSymbol>>> removeLeftRecursion(size_t);
     void removeLeftRecursion();
-    std::pair<std::string, std::vector<std::vector<IntermediateSymbol>>> leftFactoring(size_t);
+    std::pair<size_t, std::vector<std::vector<IntermediateSymbol>>> leftFactoring(size_t);
     void leftFactoring();
+    size_t newNonterminal(size_t, const char *); //Interns the first unused name nonterminal<suffix><n>
     
     ParserGeneratorPhase1(); //Call default SQL CFG configured in cfg.cpp
-    ParserGeneratorPhase1(std::initializer_list<std::pair<std::string, std::vector<std::vector<IntermediateSymbol>>>>);
+    ParserGeneratorPhase1(const GrammarDefinition&);
 
     unsigned leftRecursionRemovalDone : 1;
     unsigned leftFactoringDone : 1;
 public:
     friend class SimpleSqlParser::ParserGeneratorPhase2;
+    friend class SimpleSqlParser::RuntimeGrammar;
 };
 
 }
@@ -24,157 +24,113 @@ void ParserGeneratorPhase2::init(ParserGeneratorPhase1 &pgp1) {
     pgp1.leftFactoring();
 #ifdef DEBUG 
     pgp1.outputRules();
-    nonterminalArray = pgp1.nonterminalArray;
-#else
-    nonterminalArray = std::move(pgp1.nonterminalArray); //We do not know if move or copy?
 #endif
-    rules.resize(pgp1.rules.size());
-    std::transform(pgp1.rules.cbegin(), pgp1.rules.cend(), rules.begin(), [&](const std::vector<std::vector<ParserGeneratorPhase1::IntermediateSymbol>> &rule) {
-        std::vector<std::vector<Symbol>> newRule; newRule.resize(rule.size());
-        std::transform(rule.cbegin(), rule.cend(), newRule.begin(), [&](const std::vector<ParserGeneratorPhase1::IntermediateSymbol> &subRule) {
-            std::vector<Symbol> newSubRule; newSubRule.resize(subRule.size());
-            std::transform(subRule.cbegin(), subRule.cend(), newSubRule.begin(), [&](const ParserGeneratorPhase1::IntermediateSymbol &isymb){
-                Symbol symb;
-                if((symb.symbolType = isymb.symbolType)) {
-                    symb.symbol.nonterminalIndex = 
-                        std::find(nonterminalArray.cbegin(), nonterminalArray.cend(), *(isymb.symbol.nonterminal)) - nonterminalArray.cbegin();
+    //Interned IDs to final nonterminal indices; no name lookups needed.
+    const size_t unresolved = pgp1.nonterminalArray.size();
+    std::vector<size_t> indexOf(pgp1.nonterminals.size(), unresolved);
+    nonterminalArray.reserve(unresolved);
+    for(size_t i = 0; i < pgp1.nonterminalArray.size(); i++) {
+        indexOf[pgp1.nonterminalArray[i]] = i;
+        nonterminalArray.push_back(pgp1.nonterminals.name(pgp1.nonterminalArray[i]));
+    }
+    rules = std::move(pgp1.rules);
+    for(auto &rule : rules) {
+        for(auto &subRule : rule) for(auto &symb : subRule) if(symb.symbolType) {
 #ifdef DEBUG 
-                    if(symb.symbol.nonterminalIndex >= nonterminalArray.size())
-                        throw SyntaxError("Nonterminal " + (*isymb.symbol.nonterminal) + " not found. Check your CFG.");
+            if(indexOf[symb.symbol.nonterminalIndex] == unresolved)
+                throw SyntaxError("Nonterminal " + pgp1.nonterminals.name(symb.symbol.nonterminalIndex) + " not found. Check your CFG.");
 #endif
-                } else symb.symbol.terminal = isymb.symbol.terminal;
-                return symb;
-            });
-            newSubRule.shrink_to_fit(); return newSubRule;
-        }); SetUtil::setify(newRule);
-        return newRule;
-    });
+            symb.symbol.nonterminalIndex = indexOf[symb.symbol.nonterminalIndex];
+        }
+        SetUtil::setify(rule);
+    }
 #ifdef DEBUG
     std::cout<<"\n";
     outputRules();
 #endif
 }
+#ifdef DEBUG
+std::string strTokenSet(TokenSet set) {
+    std::string buffer;
+    for(TokenType terminal : TokenTypes) if(contains(set, terminal)) {buffer += TokenTypeNames[terminal]; buffer += " ";}
+    return buffer;
+}
+#endif
 void ParserGeneratorPhase2::generateFirstSets() {
     if(firstSetsDone) return;
-    bool runScan;
-    first.resize(nonterminalArray.size());
-    std::vector<bool> allStarted(nonterminalArray.size(), false);
-    do {
-        runScan = false;
-        for(size_t i = 0; i < nonterminalArray.size(); i++) {
-            //const std::string &nonterminal = nonterminalArray[i];
-            std::vector<TokenType> newSet(first[i]); //These are sorted sets so efficient searches can be done.
-            //Need explicit copy above otherwise it will not work.
+    const size_t count = nonterminalArray.size();
+    //users[j] holds every nonterminal with j in one of its productions; only those can change when first[j] does.
+    std::vector<std::vector<size_t>> users(count);
+    for(size_t i = 0; i < count; i++) for(const auto& subRule : rules[i]) for(const auto& symbol : subRule)
+        if(symbol.symbolType && (users[symbol.symbol.nonterminalIndex].empty() || users[symbol.symbol.nonterminalIndex].back() != i))
+            users[symbol.symbol.nonterminalIndex].push_back(i);
+
+    first.assign(count, 0);
+    std::vector<size_t> worklist(count);
+    std::vector<bool> queued(count, true);
+    for(size_t i = 0; i < count; i++) worklist[i] = count - 1 - i; //Pops in nonterminal order
+    while(!worklist.empty()) {
+        const size_t i = worklist.back(); worklist.pop_back(); queued[i] = false;
 #ifdef DEBUG
-            std::cout<<nonterminalArray[i]<<" ::= "<<strrule(rules[i], nonterminalArray)<<"\n";
+        std::cout<<nonterminalArray[i]<<" ::= "<<strrule(rules[i], nonterminalArray)<<"\n";
 #endif
-            const auto& rule = rules[i];
-            for(const auto& subRule : rule) {
-                bool allNullable = true;
-                for(const auto& subRuleSymbol : subRule) {
-                    if(subRuleSymbol.symbolType) {//Is nonterminal
-                        auto& subRuleSymbolFirst = first[subRuleSymbol.symbol.nonterminalIndex];
-                        bool NONEfound = false;
-                        for(auto& symb : subRuleSymbolFirst) 
-                            if(symb != NONE) 
-                                {newSet.push_back(symb); SetUtil::setify(newSet);}
-                            else if(symb == NONE) NONEfound = true;
-                        if(!NONEfound) {allNullable = false; break;}
-                    } else if (subRuleSymbol.symbol.terminal != NONE) {
-                        newSet.push_back(subRuleSymbol.symbol.terminal); SetUtil::setify(newSet);
-                        allNullable = false; break;
-                    } 
-                }
-                if(allNullable) {newSet.push_back(NONE); SetUtil::setify(newSet);}
-            }
-            SetUtil::setify(newSet);
-            if(!allStarted[i] || newSet != first[i]) allStarted[i] = runScan = true;
-            first[i] = std::move(newSet);
-        }
-    } while(runScan);
+        TokenSet newSet = 0;
+        for(const auto& subRule : rules[i]) newSet |= compositeFirstSet(subRule.begin(), subRule.end(), first);
+        if(newSet == first[i]) continue;
+        first[i] = newSet;
+        for(size_t user : users[i]) if(!queued[user]) {queued[user] = true; worklist.push_back(user);}
+    }
 #ifdef DEBUG 
     std::cout<<"\nFirst sets:\n";
-    for(size_t i = 0; i < nonterminalArray.size(); i++) {
-        std::cout<<nonterminalArray[i]<<" -> ";
-        for(auto& symb: first[i]) std::cout<<TokenTypeNames[symb]<<" ";
-        std::cout<<"\n";
-    }
+    for(size_t i = 0; i < count; i++) std::cout<<nonterminalArray[i]<<" -> "<<strTokenSet(first[i])<<"\n";
 #endif
     firstSetsDone = true;
 }
-std::vector<TokenType> compositeFirstSet(std::vector<Symbol>::const_iterator begin, 
-    std::vector<Symbol>::const_iterator end, const std::vector<std::vector<TokenType>> &first) {
-    std::vector<TokenType> result;
+TokenSet compositeFirstSet(std::vector<Symbol>::const_iterator begin, 
+    std::vector<Symbol>::const_iterator end, const std::vector<TokenSet> &first) {
+    TokenSet result = 0;
     for(std::vector<Symbol>::const_iterator itr = begin; itr != end; itr++) {
         const auto& symbol = *itr; 
         if(symbol.symbolType) {//Is nonterminal
-            const auto& symbolFirst = first[symbol.symbol.nonterminalIndex];
-            result.insert(result.end(), symbolFirst.begin(), symbolFirst.end()); SetUtil::setify(result);
-            if(SetUtil::bsearch(symbolFirst.begin(), symbolFirst.end(), NONE) == symbolFirst.end()) {
-                auto pos = SetUtil::bsearch(result.begin(), result.end(), NONE);
-                if(pos != result.end()) result.erase(pos);
-                break;
-            }
-        } else {
-            result.push_back(symbol.symbol.terminal); SetUtil::setify(result);
-            if(symbol.symbol.terminal != NONE) {
-                auto pos = SetUtil::bsearch(result.begin(), result.end(), NONE);
-                if(pos != result.end()) result.erase(pos);
-                break;
-            }
-        }
+            const TokenSet symbolFirst = first[symbol.symbol.nonterminalIndex];
+            result |= symbolFirst & ~tokenBit(NONE);
+            if(!contains(symbolFirst, NONE)) return result;
+        } else if(symbol.symbol.terminal != NONE) return result | tokenBit(symbol.symbol.terminal);
     }
-    SetUtil::setify(result); return result;
+    return result | tokenBit(NONE);
 }
 void ParserGeneratorPhase2::generateFollowSets() {
     if(followSetsDone) return;
     generateFirstSets(); //Required
-    follow.resize(nonterminalArray.size());
-    follow[0] = std::vector<TokenType>({EOI});
-    bool runScan;
-    std::vector<bool> allStarted(nonterminalArray.size(), false);
-#ifdef DEBUG 
-    size_t run = 0;
-#endif
-    do {
-        runScan = false;
-#ifdef DEBUG 
-        run++; std::cout<<"Run "<<run<<" for follow sets\n";
-#endif 
-        for(size_t k = 0; k < nonterminalArray.size(); k++) {
-            //const std::string &nonterminal = nonterminalArray[k];
-            const auto& rule = rules[k];
-            for(const auto& subRule : rule) {
-                for(size_t i = 0; i < subRule.size(); i++) {
-                    const auto& targetSymbol = subRule[i];
-                    if(!targetSymbol.symbolType) continue; //If not a nonterminal
-                    std::vector<TokenType> newSet(follow[targetSymbol.symbol.nonterminalIndex]); //explicit copy required
-                    
-                    const auto betaSet = compositeFirstSet(subRule.begin()+i+1, subRule.end(), first);
-                    newSet.insert(newSet.end(), betaSet.begin(), betaSet.end()); SetUtil::setify(newSet);
-                    auto temp_itr = SetUtil::bsearch(newSet.begin(), newSet.end(), NONE);
-                    if(temp_itr != newSet.end()) newSet.erase(temp_itr);
-                    
-                    const auto &alphaSet = follow[k]; //explicit copy required
-                    if(betaSet.empty() || SetUtil::bsearch(betaSet.begin(), betaSet.end(), NONE) != betaSet.end()) 
-                        {newSet.insert(newSet.end(), alphaSet.begin(), alphaSet.end()); SetUtil::setify(newSet);}
-                    
-                    SetUtil::setify(newSet);
-                    if(!allStarted[targetSymbol.symbol.nonterminalIndex] || 
-                        newSet != follow[targetSymbol.symbol.nonterminalIndex]) 
-                            allStarted[targetSymbol.symbol.nonterminalIndex] = runScan = true;
-                    follow[targetSymbol.symbol.nonterminalIndex] = std::move(newSet);
-                }
-            }
+    const size_t count = nonterminalArray.size();
+    //For every A ::= alpha B beta: FIRST(beta) goes into follow[B] once, and if beta is nullable,
+    //follow[A] flows into follow[B]; propagation only revisits nonterminals whose follow set grew.
+    std::vector<std::vector<size_t>> flowsInto(count);
+    follow.assign(count, 0);
+    follow[0] = tokenBit(EOI);
+    for(size_t k = 0; k < count; k++) for(const auto& subRule : rules[k]) for(size_t i = 0; i < subRule.size(); i++) {
+        const auto& targetSymbol = subRule[i];
+        if(!targetSymbol.symbolType) continue; //If not a nonterminal
+        const size_t target = targetSymbol.symbol.nonterminalIndex;
+        const TokenSet betaSet = compositeFirstSet(subRule.begin()+i+1, subRule.end(), first);
+        follow[target] |= betaSet & ~tokenBit(NONE);
+        if(contains(betaSet, NONE) && target != k) flowsInto[k].push_back(target);
+    }
+    std::vector<size_t> worklist(count);
+    std::vector<bool> queued(count, true);
+    for(size_t i = 0; i < count; i++) worklist[i] = count - 1 - i;
+    while(!worklist.empty()) {
+        const size_t k = worklist.back(); worklist.pop_back(); queued[k] = false;
+        for(size_t target : flowsInto[k]) {
+            const TokenSet newSet = follow[target] | follow[k];
+            if(newSet == follow[target]) continue;
+            follow[target] = newSet;
+            if(!queued[target]) {queued[target] = true; worklist.push_back(target);}
         }
-    } while (runScan);
+    }
 #ifdef DEBUG 
     std::cout<<"\nFollow sets:\n";
-    for(size_t i = 0; i < nonterminalArray.size(); i++) {
-        std::cout<<nonterminalArray[i]<<" -> ";
-        for(auto& symb: follow[i]) std::cout<<TokenTypeNames[symb]<<" ";
-        std::cout<<"\n";
-    }
+    for(size_t i = 0; i < count; i++) std::cout<<nonterminalArray[i]<<" -> "<<strTokenSet(follow[i])<<"\n";
 #endif
     followSetsDone = true;
 }
@@ -185,29 +141,24 @@ void ParserGeneratorPhase2::checkIfLL1() {
     for(size_t i = 0; i < nonterminalArray.size(); i++) {
         const std::string &nonterminal = nonterminalArray[i];
         const auto& rule = rules[i];
-        if(SetUtil::bsearch(rule.begin(), rule.end(), std::vector<Symbol>()) != rule.end() &&
-            !SetUtil::isdisjoint(first[i].begin(), first[i].end(), follow[i].begin(), follow[i].end())) {
+        if(SetUtil::bsearch(rule.begin(), rule.end(), std::vector<Symbol>()) != rule.end() && (first[i] & follow[i])) {
             err<<"Grammar is not LL(1); for nonterminal "<<nonterminal
                 <<"\nThe nonterminal produces an empty string and first and follow sets are not disjoint.";
-            err<<"\nFirst set: ";
-            for(auto& symb : first[i]) err<<TokenTypeNames[symb]<<" ";
-            err<<"\nFollow set: ";
-            for(auto& symb : follow[i]) err<<TokenTypeNames[symb]<<" ";
+            err<<"\nFirst set: "<<strTokenSet(first[i]);
+            err<<"\nFollow set: "<<strTokenSet(follow[i]);
             throw SyntaxError(err.str());
         }
         for(size_t j = 0; j < rule.size()-1; j++) for(size_t k = j+1; k < rule.size(); k++) {
             const auto& prod1 = rule[j], prod2 = rule[k];
             if(prod1.empty() || prod2.empty()) continue;
-            const auto prod1First = compositeFirstSet(prod1.begin(), prod1.end(), first);
-            const auto prod2First = compositeFirstSet(prod2.begin(), prod2.end(), first);
-            if(SetUtil::isdisjoint(prod1First.begin(), prod1First.end(), prod2First.begin(), prod2First.end())) continue;
+            const TokenSet prod1First = compositeFirstSet(prod1.begin(), prod1.end(), first);
+            const TokenSet prod2First = compositeFirstSet(prod2.begin(), prod2.end(), first);
+            if(!(prod1First & prod2First)) continue;
             err<<"Grammar is not LL(1); for nonterminal "<<nonterminal
                 <<"\nFirst sets for two of the productions of the nonterminal are not disjoint.";
             err<<"\nFor productions:\n";
-            err<<nonterminal<<" ::= "<<strSubRule(prod1, nonterminalArray)<<"; first set = ";
-            for(auto& symb : prod1First) err<<TokenTypeNames[symb]<<" ";
-            err<<"\n"<<nonterminal<<" ::= "<<strSubRule(prod2, nonterminalArray)<<"; first set = ";
-            for(auto& symb : prod2First) err<<TokenTypeNames[symb]<<" ";
+            err<<nonterminal<<" ::= "<<strSubRule(prod1, nonterminalArray)<<"; first set = "<<strTokenSet(prod1First);
+            err<<"\n"<<nonterminal<<" ::= "<<strSubRule(prod2, nonterminalArray)<<"; first set = "<<strTokenSet(prod2First);
             throw SyntaxError(err.str());
         }
     }
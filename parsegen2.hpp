@@ -3,9 +3,16 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 #include "parsegen1.hpp"
 
 namespace SimpleSqlParser {
+//FIRST and FOLLOW sets as a bitmask over TokenType. The NONE bit marks a nullable (epsilon) set.
+typedef uint64_t TokenSet;
+static_assert(EOI < 64, "TokenSet needs one bit per TokenType");
+inline constexpr TokenSet tokenBit(TokenType ttype) noexcept {return (TokenSet)1 << ttype;}
+inline constexpr bool contains(TokenSet set, TokenType ttype) noexcept {return set & tokenBit(ttype);}
+
 class ParserGeneratorPhase3;
 //Factory class for Parser, phase 2: first and follow sets (at the end we will know if we are really LL(1))
 class ParserGeneratorPhase2 {
@@ -15,7 +22,7 @@ public:
 #endif
     std::vector<std::string> nonterminalArray;
     std::vector<std::vector<std::vector<Symbol>>> rules;
-    std::vector<std::vector<TokenType>> first, follow;
+    std::vector<TokenSet> first, follow;
 
     void init(ParserGeneratorPhase1&);
     void generateFirstSets();
@@ -30,10 +37,10 @@ public:
     unsigned followSetsDone : 1;
 public:
     friend class SimpleSqlParser::ParserGeneratorPhase3;
+    friend class SimpleSqlParser::RuntimeGrammar;
 };
-//Outside because required by following phases.
-std::vector<TokenType> compositeFirstSet(std::vector<Symbol>::const_iterator, 
-    std::vector<Symbol>::const_iterator, const std::vector<std::vector<TokenType>>&);
+//Outside because required by following phases. Has the NONE bit if the whole range is nullable (or empty).
+TokenSet compositeFirstSet(std::vector<Symbol>::const_iterator, std::vector<Symbol>::const_iterator, const std::vector<TokenSet>&);
 }
 
 #endif
\ No newline at end of file
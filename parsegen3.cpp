@@ -1,7 +1,6 @@
 #include "parsegen3.hpp"
 #include "lexer.hpp"
 #include <utility>
-#include "setutil.hpp"
 #ifdef DEBUG 
 #include <sstream>
 #include <iostream>
@@ -31,6 +30,7 @@ void ParserGeneratorPhase3::init(ParserGeneratorPhase2 &pgp2) {
     rules = pgp2.rules; first = pgp2.first; follow = pgp2.follow;
 #else
     pgp2.generateFollowSets();
+    nonterminalArray = std::move(pgp2.nonterminalArray);
     rules = std::move(pgp2.rules);
     first = std::move(pgp2.first); follow = std::move(pgp2.follow);
 #endif
@@ -42,13 +42,10 @@ void ParserGeneratorPhase3::generateParsingTable() {
 #endif
     parsingTable.resize(rules.size(), std::vector<ParsingTableEntry>(TokenTypes.size()));
     for(size_t i = 0; i < rules.size(); i++) {
+        const TokenSet predicted = contains(first[i], NONE) ? first[i] | follow[i] : first[i];
         for(TokenType terminal : TokenTypes) {
-            if(!(SetUtil::bsearch(first[i].begin(), first[i].end(), terminal) != first[i].end() || 
-                (SetUtil::bsearch(first[i].begin(), first[i].end(), NONE) != first[i].end() && 
-                SetUtil::bsearch(follow[i].begin(), follow[i].end(), terminal) != follow[i].end()))) 
-                parsingTable[i][terminal] 
-                    = (terminal == EOI || SetUtil::bsearch(follow[i].begin(), follow[i].end(), terminal) != follow[i].end()) ?
-                        errorRecovery(POP) : errorRecovery(SCAN);
+            if(!contains(predicted, terminal)) 
+                parsingTable[i][terminal] = (terminal == EOI || contains(follow[i], terminal)) ? errorRecovery(POP) : errorRecovery(SCAN);
 #ifdef DEBUG
             else parsingTable[i][terminal].actionType = 0; //NOT an action
 #endif
@@ -59,13 +56,9 @@ void ParserGeneratorPhase3::generateParsingTable() {
         const auto& rule = rules[i];
         for(size_t subRuleIndex = 0; subRuleIndex < rule.size(); subRuleIndex++) {
             const auto &subRule = rule[subRuleIndex];
-            const auto firstSet = compositeFirstSet(subRule.begin(), subRule.end(), first);
-            bool NONEfound = false;
-            for(TokenType terminal : firstSet) {
-                parsingTableAssign(i, terminal, subRuleIndex);
-                if(terminal == NONE) NONEfound = true;
-            }
-            if(NONEfound || firstSet.empty()) for(TokenType terminal : follow[i]) parsingTableAssign(i, terminal, subRuleIndex);
+            TokenSet predicted = compositeFirstSet(subRule.begin(), subRule.end(), first);
+            if(contains(predicted, NONE)) predicted = (predicted | follow[i]) & ~tokenBit(NONE); //NONE is never a lookahead
+            for(TokenType terminal : TokenTypes) if(contains(predicted, terminal)) parsingTableAssign(i, terminal, subRuleIndex);
         } 
     }
 
@@ -86,5 +79,3 @@ void ParserGeneratorPhase3::generateParsingTable() {
 }
 
 }
-
-#include "setutil.cpp"
\ No newline at end of file
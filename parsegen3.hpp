@@ -2,23 +2,21 @@
 #define __PARSEGEN3__
 
 #include <vector>
-#include "parsegen2.hpp"
-#ifdef DEBUG 
 #include <string>
-#endif
+#include "parsegen2.hpp"
 
 namespace SimpleSqlParser {
 //Factory class for Parser, phase 3: parsing table construction.
 class ParserGeneratorPhase3  {
+    std::vector<std::string> nonterminalArray;
 #ifdef DEBUG 
 public:
-    std::vector<std::string> nonterminalArray;
     void parsingTableAssign(size_t, TokenType, size_t);
 #else
     void parsingTableAssign(size_t i, TokenType k, size_t si) {parsingTable[i][k] = stackAction(si);};
 #endif
     std::vector<std::vector<std::vector<Symbol>>> rules;
-    std::vector<std::vector<TokenType>> first, follow;
+    std::vector<TokenSet> first, follow;
     std::vector<std::vector<ParsingTableEntry>> parsingTable;
 
     void init(ParserGeneratorPhase2&);
@@ -28,7 +26,7 @@ public:
 
     unsigned parsingTableDone : 1;
 public:
-    friend class SimpleSqlParser::Parser;
+    friend class SimpleSqlParser::RuntimeGrammar;
 };
 }
 
@@ -1,127 +1,208 @@
-#include "parsegen3.hpp"
 #include "parser.hpp"
 #include "error.hpp"
+#include "parsetree.hpp"
 #include <utility>
 #ifdef DEBUG 
 #include <iostream>
 #endif
 
 namespace SimpleSqlParser {
-//Symbol
-int Symbol::compare(const Symbol &symb) const noexcept {
-    if(symbolType < symb.symbolType) return -1;
-    else if(symbolType > symb.symbolType) return 1;
-    else if(symbolType) {
-        if(symbol.nonterminalIndex < symb.symbol.nonterminalIndex) return -1;
-        else if(symbol.nonterminalIndex > symb.symbol.nonterminalIndex) return 1;
-        else return 0;
-    } else {
-        if(symbol.terminal < symb.symbol.terminal) return -1;
-        else if(symbol.terminal > symb.symbol.terminal) return 1;
-        else return 0;
-    }
-}
-
 #ifdef DEBUG
-std::string strSubRule(const std::vector<Symbol> &subRule, const std::vector<std::string> &nonterminalArray) {
+std::string strProduction(const PackedSymbol *reversed, size_t length, const char *const *nonterminalNames) {
     std::string buffer;
-    if(subRule.size() < 1) return std::string("?");
-    for(size_t i = 0; i < subRule.size(); i++) {
-        buffer += (subRule[i].symbolType ? nonterminalArray[subRule[i].symbol.nonterminalIndex] : TokenTypeNames[subRule[i].symbol.terminal]);
-        if(i < (subRule.size() - 1)) buffer += " ";
+    if(length < 1) return std::string("?");
+    for(size_t i = length; i > 0; i--) {
+        PackedSymbol symb = reversed[i-1];
+        buffer += (symb.isNonterminal() ? nonterminalNames[symb.nonterminalIndex()] : TokenTypeNames[symb.terminal()]);
+        if(i > 1) buffer += " ";
     } 
     return buffer;
 }
-std::string strStack(const std::deque<Symbol> &stack, const std::vector<std::string> &nonterminalArray) {
+std::string strStack(const ParsingStack &stack, const char *const *nonterminalNames) {
     std::string buffer("{"); size_t i = 0;
-    for(Symbol symb : stack) {
-        buffer += (symb.symbolType ? nonterminalArray[symb.symbol.nonterminalIndex] : TokenTypeNames[symb.symbol.terminal]);
+    for(PackedSymbol symb : stack) {
+        if(symb.isExitMarker()) buffer += std::string("/") + nonterminalNames[symb.exitedNonterminal()];
+        else buffer += (symb.isNonterminal() ? nonterminalNames[symb.nonterminalIndex()] : TokenTypeNames[symb.terminal()]);
         if(i < (stack.size() - 1)) buffer.push_back(' ');
         i++;
     } buffer.push_back('}');
     return buffer;
 }
-std::string strrule(const std::vector<std::vector<Symbol>> &rule, const std::vector<std::string> &nonterminalArray) {
-    std::string buffer;
-    for(size_t i = 0; i < rule.size(); i++) {
-        buffer += strSubRule(rule[i], nonterminalArray);
-        if(i < (rule.size() - 1)) buffer += " | ";
+#endif
+
+//ParsingStack
+void ParsingStack::reserve(size_t n) {
+    if(n <= capacity) return;
+    size_t newCapacity = capacity * 2; 
+    if(newCapacity < n) newCapacity = n;
+    PackedSymbol *newData = new PackedSymbol[newCapacity];
+    std::memcpy(newData, data, count * sizeof(PackedSymbol));
+    if(data != inlineBuffer) delete[] data;
+    data = newData; capacity = newCapacity;
+}
+
+namespace {
+//The nonterminal which the start symbol repeats (stmt in stmt_list ::= stmt ';' stmt_list); SIZE_MAX if none.
+size_t findStatementNonterminal(const CompiledGrammar &grammar) noexcept {
+    for(size_t terminal = 0; terminal < CompiledGrammar::tokenCount; terminal++) {
+        const CompiledGrammar::Action action = grammar.action(0, (TokenType)terminal);
+        if(CompiledGrammar::isErrorAction(action) || grammar.productionLength(action) == 0) continue;
+        const PackedSymbol first = grammar.productionSymbols(action)[grammar.productionLength(action)-1]; //Pushed last
+        if(first.isNonterminal()) return first.nonterminalIndex();
     }
-    return buffer;
+    return SIZE_MAX;
+}
 }
-const char *ErrorRecoveryNames[] = {"POP", "SCAN"}; 
-#endif
 
-Parser::Parser(ParserGeneratorPhase3 &pgp3, std::istream *src) : lexer(src), firstParse(false), unrecoverable(false) {init(pgp3);}
-Parser::Parser(std::istream *src) : lexer(src), firstParse(false), unrecoverable(false) {ParserGeneratorPhase3 pgp3; init(pgp3);}
-Parser::Parser() : firstParse(false), unrecoverable(false) {ParserGeneratorPhase3 pgp3; init(pgp3);}
+Parser::Parser(std::shared_ptr<const CompiledGrammar> grammar, std::istream *src) : grammar(std::move(grammar)), lexer(src), 
+    statementNonterminal(findStatementNonterminal(*this->grammar)), tree(nullptr), firstParse(false), stopped(false), unrecoverable(false) {restart();}
+Parser::Parser(std::istream *src) : Parser(sharedSqlGrammar(), src) {}
+Parser::Parser() : Parser(sharedSqlGrammar()) {}
+void Parser::restart() noexcept {
+    parsingStack.clear(); nodeStack.clear();
+    statementKind = statementNonterminal; lastOffset = lastLength = 0; lastLocation = Lexer::Location();
+    firstParse = false; stopped = false; unrecoverable = false;
+}
 void Parser::reopen(std::istream *src) {
-    parsingStack.clear();
     lexer.reopen(src);
-    firstParse = false; unrecoverable = false;
+    restart();
 }
-void Parser::init(ParserGeneratorPhase3 &pgp3) {
-    pgp3.generateParsingTable();
-#ifdef DEBUG 
-    nonterminalArray = pgp3.nonterminalArray;
-    rules = pgp3.rules; parsingTable = pgp3.parsingTable;
-#else
-    rules = std::move(pgp3.rules); parsingTable = std::move(pgp3.parsingTable);
-#endif
+void Parser::reopen(const char *begin, const char *end) {
+    lexer.reopen(begin, end);
+    restart();
+}
+void Parser::reopen(const char *begin, const char *end, const Lexer::Position &start) {
+    lexer.reopen(begin, end, start);
+    restart();
 }
-void Parser::continueParse() {
+void Parser::continueParse() {stopped = false; run(nullptr);}
+size_t Parser::parse(const DiagnosticSink &sink, size_t maxErrors) {
+    size_t errors = 0;
+    stopped = (maxErrors == 0);
+    const DiagnosticSink counted = [&](const Diagnostic &diagnostic) {
+        if(stopped) return; //The lexer may still report while the parser finishes its step.
+        sink(diagnostic);
+        if(++errors == maxErrors) stopped = true;
+    };
+    lexer.setDiagnosticSink(&counted);
+    run(&counted);
+    lexer.setDiagnosticSink(nullptr);
+    return errors;
+}
+void Parser::recover(ErrorRecovery recovery) {
+    switch(recovery) {
+    case POP: parsingStack.pop_back(); if(tree) nodeStack.pop_back(); break; //The node stays missing.
+    case SCAN: lexer.getNextToken(); break;
+    }
+}
+void Parser::emit(ParseEvent::Kind kind, size_t nonterminal, bool atLookahead) {
+    const uint64_t fingerprint = (kind == ParseEvent::STATEMENT_END) ? lexer.getStatementFingerprint() : 0;
+    if(atLookahead) listener({kind, nonterminal, lexer.getCurrentLexemeOffset(), lexer.getCurrentLexemeLength(), lexer.getCurrentLexemeLocation(), NONE, fingerprint});
+    else listener({kind, nonterminal, lastOffset, lastLength, lastLocation, NONE, fingerprint});
+}
+void Parser::run(const DiagnosticSink *sink) {
+    if(listener) {if(tree) run<true, true>(sink); else run<true, false>(sink);}
+    else if(tree) run<false, true>(sink); else run<false, false>(sink);
+}
+//withEvents: exit markers are pushed under each expansion and the listener is called. withTree: nodeStack
+//follows parsingStack and tree nodes are filled in. The instance with neither is the plain LL(1) loop.
+template<bool withEvents, bool withTree> void Parser::run(const DiagnosticSink *sink) {
     if(!firstParse) {
-        parsingStack.insert(parsingStack.end(), {terminal(EOI), nonterminal(0)});
+        parsingStack.push_back(pack(terminal(EOI))); parsingStack.push_back(pack(nonterminal(0)));
+        if constexpr(withTree) {
+            tree->clear(); (*tree)[tree->allocate(1)].symbol = pack(nonterminal(0));
+            nodeStack.push_back(SIZE_MAX); nodeStack.push_back(0); //EOI gets no node.
+        }
+        firstParse = true; //Before reading, so that a lexical error leaves a parser which can be resumed.
         lexer.getNextToken(); //get first lookahead token
-        firstParse = true;
     }
-    while(!parsingStack.empty()) {
+    while(!parsingStack.empty() && !stopped) {
 #ifdef DEBUG 
-        std::cout<<"\nStack is "<<strStack(parsingStack, nonterminalArray);
+        std::cout<<"\nStack is "<<strStack(parsingStack, grammar->nonterminalNames);
         std::cout<<"\nCurrent input terminal is: "; lexer.showstatus();
         std::cout<<"\nCurrent position: "<<constructMessageStr(lexer.getCurrentLexemeLocation())<<"\n\n";
 #endif
-        Symbol symbol(parsingStack.back()); //I need only to peek
-        if(!symbol.symbolType && lexer.match(symbol.symbol.terminal)) {//We have a direct match
+        const PackedSymbol symbol = parsingStack.back(); //I need only to peek
+        if constexpr(withEvents) if(symbol.isExitMarker()) {
+            parsingStack.pop_back();
+            if constexpr(withTree) nodeStack.pop_back();
+            emit(ParseEvent::EXIT, symbol.exitedNonterminal(), false);
+            if(symbol.exitedNonterminal() == statementNonterminal) emit(ParseEvent::STATEMENT_END, statementKind, false);
+            continue;
+        }
+        if(!symbol.isNonterminal() && lexer.getCurrentToken() == symbol.terminal()) {//We have a direct match
 #ifdef DEBUG
             std::cout<<"We have a direct match. Going over to next input terminal.\n";
 #endif
-            parsingStack.pop_back(); continue;
+            parsingStack.pop_back(); //Before reading, so that a lexical error leaves the match done.
+            if constexpr(withEvents) {
+                lastOffset = lexer.getCurrentLexemeOffset(); lastLength = lexer.getCurrentLexemeLength();
+                lastLocation = lexer.getCurrentLexemeLocation();
+                listener({ParseEvent::TOKEN, SIZE_MAX, lastOffset, lastLength, lastLocation, symbol.terminal(), 0});
+            }
+            if constexpr(withTree) {
+                const size_t node = nodeStack.back(); nodeStack.pop_back();
+                if(node != SIZE_MAX) (*tree)[node] = {symbol, false, lexer.getCurrentLexemeOffset(), lexer.getCurrentLexemeLength()};
+            }
+            lexer.getNextToken(); continue;
         }
-        else if(!symbol.symbolType) { //Unexpected token! Unrecoverable error.
-            SyntaxError ex(lexer.getCurrentLexemeLocation(), 
-#ifdef DEBUG                 
-                std::string("Unrecoverable ") +
-#endif
-                std::string("Error; expected ") + TokenTypeNames[symbol.symbol.terminal] 
-                + "; found " + lexer.getCurrentLexeme() + " [" + TokenTypeNames[lexer.getCurrentToken()] + "]");
+        else if(!symbol.isNonterminal()) { //Unexpected token! Unrecoverable error.
+            const Diagnostic diagnostic{Diagnostic::EXPECTED_TOKEN, lexer.getCurrentLexemeLocation(), 
+                symbol.terminal(), lexer.getCurrentToken(), lexer.getCurrentLexemeView()};
             unrecoverable = (lexer.getCurrentToken() == EOI) ? true : false; //Try skipping over tokens I guess.
-            if(!unrecoverable) lexer.getNextToken();
-            throw ex;
+            if(!sink) {
+                SyntaxError ex(diagnostic);
+                if(!unrecoverable) lexer.getNextToken();
+                throw ex;
+            }
+            (*sink)(diagnostic);
+            if(unrecoverable) return;
+            lexer.getNextToken(); continue;
         }
-        const auto& action = parsingTable[symbol.symbol.nonterminalIndex][lexer.getCurrentToken()];
-        if(!action.actionType) {//Error recovery
-            SyntaxError ex(lexer.getCurrentLexemeLocation(), 
-                std::string("Error; unexpected token ") 
-                    + lexer.getCurrentLexeme() + " [" + TokenTypeNames[lexer.getCurrentToken()] + "]"
+        const CompiledGrammar::Action action = grammar->action(symbol.nonterminalIndex(), lexer.getCurrentToken());
+        if(CompiledGrammar::isErrorAction(action)) {//Error recovery
+            const Diagnostic diagnostic{Diagnostic::UNEXPECTED_TOKEN, lexer.getCurrentLexemeLocation(), 
+                NONE, lexer.getCurrentToken(), lexer.getCurrentLexemeView()};
 #ifdef DEBUG
-                    + "; doing " + ErrorRecoveryNames[action.action.recoveryAction] + " to recover"
+            std::cout<<"Doing "<<ErrorRecoveryNames[CompiledGrammar::recoveryOf(action)]<<" to recover\n";
 #endif
-                    );
-            switch(action.action.recoveryAction) {
-            case POP: parsingStack.pop_back(); break;
-            case SCAN: lexer.getNextToken(); break;
+            if(!sink) {
+                SyntaxError ex(diagnostic);
+                recover(CompiledGrammar::recoveryOf(action));
+                throw ex;
             }
-            throw ex;
+            (*sink)(diagnostic); //Before recovering; the lexeme may be gone after it.
+            recover(CompiledGrammar::recoveryOf(action)); continue;
         }
         parsingStack.pop_back();
+        [[maybe_unused]] size_t node = 0;
+        if constexpr(withTree) {node = nodeStack.back(); nodeStack.pop_back();}
         //Directly push the rule on stack. Symbol matching should take care of the rest.
-        const auto& subRule = rules[symbol.symbol.nonterminalIndex][action.action.subRuleIndex];
 #ifdef DEBUG
-        std::cout<<"Doing "<<nonterminalArray[symbol.symbol.nonterminalIndex]
-            <<" ::= "<<strSubRule(subRule, nonterminalArray)<<std::endl;
+        std::cout<<"Doing "<<grammar->nonterminalNames[symbol.nonterminalIndex()]<<" ::= "
+            <<strProduction(grammar->productionSymbols(action), grammar->productionLength(action), grammar->nonterminalNames)<<std::endl;
 #endif
-        parsingStack.insert(parsingStack.end(), subRule.rbegin(), subRule.rend());
+        if constexpr(withEvents) {
+            const size_t nonterminal = symbol.nonterminalIndex(), length = grammar->productionLength(action);
+            if(nonterminal == statementNonterminal) {
+                const PackedSymbol first = length ? grammar->productionSymbols(action)[length-1] : symbol;
+                statementKind = first.isNonterminal() ? first.nonterminalIndex() : nonterminal;
+                emit(ParseEvent::STATEMENT_START, statementKind, true);
+            }
+            emit(ParseEvent::ENTER, nonterminal, true);
+            parsingStack.push_back(exitMarker(nonterminal));
+            if constexpr(withTree) nodeStack.push_back(SIZE_MAX);
+        }
+        if constexpr(withTree) { //The children get consecutive nodes, in the order of the production.
+            const size_t length = grammar->productionLength(action), first = tree->allocate(length);
+            const PackedSymbol *symbols = grammar->productionSymbols(action); //Reversed
+            (*tree)[node] = {symbol, false, first, length};
+            for(size_t i = 0; i < length; i++) {
+                (*tree)[first + length-1 - i].symbol = symbols[i];
+                nodeStack.push_back(first + length-1 - i);
+            }
+        }
+        parsingStack.push(grammar->productionSymbols(action), grammar->productionLength(action));
     }
     //Success!
 }
@@ -2,91 +2,115 @@
 #define __PARSER__
 
 #include "lexer.hpp"
+#include "grammar.hpp"
+#include <cstring>
+#include <memory>
+#include <cstdint>
+#include <functional>
+#include <utility>
 #include <vector>
-#include <deque>
-#ifdef DEBUG
-#include <string>
-#endif
 
 namespace SimpleSqlParser {
-//This needs to be hashable.
-struct Symbol {
-    union {
-        TokenType terminal;
-        size_t nonterminalIndex;
-    } symbol;
-    unsigned symbolType : 1; //1 or true value if nonterminal
-
-    int compare(const Symbol&) const noexcept;
+//Contiguous stack of PackedSymbols. Lives in an inline buffer until it grows past inlineCapacity.
+class ParsingStack {
+    static constexpr size_t inlineCapacity = 64;
+    PackedSymbol *data;
+    size_t count, capacity;
+    PackedSymbol inlineBuffer[inlineCapacity];
+    void reserve(size_t);
+public:
+    ParsingStack() noexcept : data(inlineBuffer), count(0), capacity(inlineCapacity) {}
+    ParsingStack(const ParsingStack &other) : ParsingStack() {*this = other;}
+    ParsingStack &operator=(const ParsingStack &other) {
+        if(this != &other) {count = 0; push(other.data, other.count);}
+        return *this;
+    }
+    ~ParsingStack() noexcept {if(data != inlineBuffer) delete[] data;}
 
-    bool operator==(const Symbol &symb) const noexcept {return compare(symb) == 0;}
-    bool operator!=(const Symbol &symb) const noexcept {return compare(symb) != 0;}
-    bool operator<(const Symbol &symb) const noexcept {return compare(symb) < 0;}
-    bool operator<=(const Symbol &symb) const noexcept {return compare(symb) <= 0;}
-    bool operator>(const Symbol &symb) const noexcept {return compare(symb) > 0;}
-    bool operator>=(const Symbol &symb) const noexcept {return compare(symb) >= 0;}
+    bool empty() const noexcept {return count == 0;}
+    size_t size() const noexcept {return count;}
+    PackedSymbol back() const noexcept {return data[count-1];}
+    void pop_back() noexcept {count--;}
+    void clear() noexcept {count = 0;}
+    void push_back(PackedSymbol symb) {if(count == capacity) reserve(count+1); data[count++] = symb;}
+    void push(const PackedSymbol *symbols, size_t n) { //symbols[n-1] ends up on top.
+        if(count + n > capacity) reserve(count + n);
+        std::memcpy(data + count, symbols, n * sizeof(PackedSymbol)); count += n;
+    }
+    const PackedSymbol *begin() const noexcept {return data;}
+    const PackedSymbol *end() const noexcept {return data + count;}
 };
-inline Symbol terminal(TokenType ttype) {Symbol s; s.symbolType = 0; s.symbol.terminal = ttype; return s;}
-inline Symbol nonterminal(size_t ntindex) {Symbol s; s.symbolType = 1; s.symbol.nonterminalIndex = ntindex; return s;}
-#ifdef DEBUG
-std::string strSubRule(const std::vector<Symbol>&, const std::vector<std::string>&);
-std::string strrule(const std::vector<std::vector<Symbol>>&, const std::vector<std::string>&);
-#endif
-
-enum ErrorRecovery : unsigned char {POP, SCAN};
-#ifdef DEBUG 
-extern const char *ErrorRecoveryNames[];
-#endif
 
-struct ParsingTableEntry {
-    union {
-        ErrorRecovery recoveryAction;
-        size_t subRuleIndex;
-        size_t &stackAction() noexcept {return subRuleIndex;} //type alias
-        size_t stackAction() const noexcept {return subRuleIndex;} //type alias
-    } action;
-    unsigned actionType : 1; //1 or true value if stackAction
+//What Parser reports to a ParseListener, in input order.
+struct ParseEvent {
+    enum Kind : unsigned char {
+        STATEMENT_START, STATEMENT_END, //Of each statement; nonterminal is its kind, e.g. select_stmt (see Parser).
+        ENTER, EXIT, //Expansion of a nonterminal and the end of what it expanded to
+        TOKEN //A terminal matched; during the call, Parser::getLexer() is still on it (lexeme, value).
+    };
+    Kind kind;
+    size_t nonterminal; //Index into CompiledGrammar::nonterminalNames; SIZE_MAX for TOKEN.
+    //STATEMENT_START, ENTER: the lookahead token, i.e. the first token of the statement or nonterminal (if any).
+    //STATEMENT_END, EXIT: the last token matched, i.e. the end is just past offset + length. TOKEN: that token.
+    size_t offset, length;
+    Lexer::Location location;
+    TokenType token; //TOKEN only
+    uint64_t fingerprint; //STATEMENT_END only: Lexer::getStatementFingerprint() once its ';' has been read.
 };
-inline ParsingTableEntry errorRecovery(ErrorRecovery action) 
-{ParsingTableEntry e; e.actionType = 0; e.action.recoveryAction = action; return e;}
-inline ParsingTableEntry stackAction(size_t subRuleIndex) 
-{ParsingTableEntry e; e.actionType = 1; e.action.subRuleIndex = subRuleIndex; return e;}
+typedef std::function<void(const ParseEvent&)> ParseListener;
 
-//Main parser. requires ParserGeneratorPhase3.
-class ParserGeneratorPhase3;
+class ParseTree; //See parsetree.hpp
+
+//Main parser. Only a cursor over a shared, immutable CompiledGrammar (sqlGrammar unless given one):
+//holds nothing but the parsing stack and the Lexer's input state, so it is cheap to create one per thread.
 class Parser {
-#ifdef DEBUG 
-public:
-    std::vector<std::string> nonterminalArray;
-#endif
-    std::vector<std::vector<std::vector<Symbol>>> rules;
-    std::vector<std::vector<ParsingTableEntry>> parsingTable;
-    std::deque<Symbol> parsingStack;
+    std::shared_ptr<const CompiledGrammar> grammar;
+    ParsingStack parsingStack;
     Lexer lexer;
-    
-    Parser(ParserGeneratorPhase3&, std::istream *);
-    void init(ParserGeneratorPhase3&);
+
+    ParseListener listener;
+    size_t statementNonterminal; //Nonterminal of each statement: the first symbol of the start symbol's recursion.
+    size_t statementKind; //Of the statement being parsed
+    size_t lastOffset, lastLength; Lexer::Location lastLocation; //Last token matched, for STATEMENT_END and EXIT.
+    ParseTree *tree;
+    std::vector<size_t> nodeStack; //Tree node of each symbol on parsingStack, when building a tree
+
+    void run(const DiagnosticSink *); //Errors go to the sink, or are thrown when there is none.
+    template<bool withEvents, bool withTree> void run(const DiagnosticSink *);
+    void emit(ParseEvent::Kind, size_t nonterminal, bool atLookahead);
+    void restart() noexcept; //After reopen
+    void recover(ErrorRecovery);
 public:
+    Parser(std::shared_ptr<const CompiledGrammar>, std::istream * = nullptr);
     Parser(std::istream *);
     Parser(); //No file?
     void reopen(std::istream *);
+    void reopen(const char *, const char *); //Parse a buffer in place; it must outlive the parse.
+    void reopen(const char *, const char *, const Lexer::Position &); //Buffer is part of a larger input.
     void continueParse(); //continue or start; throws exception on error and can be used to resume even after error.
+    //Parses to the end of the input (or an unrecoverable error) without throwing: every error is passed to sink,
+    //in input order, and parsing recovers as continueParse would. Returns the number of errors. Stops early once
+    //maxErrors have been reported; calling parse again resumes.
+    size_t parse(const DiagnosticSink &sink, size_t maxErrors = SIZE_MAX);
+    //Reports statements and the nonterminals they expand to while parsing. Statements are what the start symbol
+    //repeats (stmt in cfg.cpp); a statement's kind is the nonterminal its production starts with, or the statement
+    //nonterminal itself for an empty statement. Set it before parsing an input, not midway. Without a listener
+    //(the default), the parser runs exactly as if events did not exist.
+    void setListener(ParseListener listener) {this->listener = std::move(listener);}
+    //Builds the concrete syntax tree of each input into tree (cleared when parsing of an input starts). Set it
+    //before parsing an input, not midway. Without a tree (nullptr, the default), nothing is built or allocated.
+    void setTree(ParseTree *tree) noexcept {this->tree = tree;}
+    const Lexer &getLexer() const noexcept {return lexer;}
+    const CompiledGrammar &getGrammar() const noexcept {return *grammar;}
     
     //The following must be at the end since these are bit-fields.
 private:
     unsigned firstParse : 1;
+    unsigned stopped : 1; //parse reached maxErrors
 public:
     unsigned unrecoverable : 1; //Flag set if we get an unrecoverable error (usually unexpected tokens.)
 };
 
 }
 
-#include <functional>
-template<> struct std::hash<SimpleSqlParser::Symbol> {
-    size_t operator()(const SimpleSqlParser::Symbol &symb) const noexcept {
-        return symb.symbolType ? symb.symbol.nonterminalIndex << 1 : ((size_t)symb.symbol.terminal << 1) + 1;
-    }
-};
-
-
 #endif
\ No newline at end of file
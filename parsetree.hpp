@@ -0,0 +1,36 @@
+#ifndef __PARSETREE__
+#define __PARSETREE__
+
+#include <cstddef>
+#include <vector>
+#include "grammar.hpp"
+
+namespace SimpleSqlParser {
+//Concrete syntax tree built by Parser (see Parser::setTree): a node for every symbol of every production expanded,
+//rooted at the start symbol (node 0). The children of a node are allocated together when it is expanded, so they
+//are a contiguous range of indices. Nodes are bump-allocated from one array: no allocation per node, and clear()
+//drops a whole tree at once while keeping the memory for the next one.
+class ParseTree {
+public:
+    struct Node {
+        PackedSymbol symbol{0};
+        bool missing = true; //Not matched or expanded, because of a syntax error.
+        //Nonterminal: children [begin, begin + length). Terminal: input offset and length of its lexeme, e.g. a
+        //slice of the buffer given to Parser::reopen.
+        size_t begin = 0, length = 0;
+    };
+private:
+    std::vector<Node> nodes;
+public:
+    size_t allocate(size_t count) {const size_t first = nodes.size(); nodes.resize(first + count); return first;}
+    void clear() noexcept {nodes.clear();}
+
+    bool empty() const noexcept {return nodes.empty();}
+    size_t size() const noexcept {return nodes.size();}
+    Node &operator[](size_t i) noexcept {return nodes[i];}
+    const Node &operator[](size_t i) const noexcept {return nodes[i];}
+    const Node &root() const noexcept {return nodes[0];}
+};
+}
+
+#endif
@@ -0,0 +1,48 @@
+#include "pushparser.hpp"
+#include "bytescan.hpp"
+#include <utility>
+
+namespace SimpleSqlParser {
+//PushParser
+PushParser::PushParser(StatementCallback onStatement, DiagnosticSink onDiagnostic, std::shared_ptr<const CompiledGrammar> grammar) : 
+    parser(std::move(grammar)), onStatement(std::move(onStatement)), onDiagnostic(std::move(onDiagnostic)), position{0, 1, 0}, cache(nullptr) {}
+void PushParser::parseStatement(const char *begin, const char *end) {
+    const std::string_view statement(begin, end - begin);
+    if(cache) {
+        const std::shared_ptr<const ValidationCache::Result> result = cache->validate(parser, statement);
+        for(Diagnostic diagnostic : result->diagnostics) {
+            diagnostic.location = ValidationCache::relocate(diagnostic, position);
+            onDiagnostic(diagnostic);
+        }
+        onStatement(statement, result->diagnostics.size(), result->fingerprint);
+    } else {
+        parser.reopen(begin, end, position);
+        const size_t errors = parser.parse(onDiagnostic);
+        onStatement(statement, errors, parser.getLexer().getStatementFingerprint());
+    }
+    const char *lastNewline = nullptr;
+    position.lineNumber += ByteScan::countNewlines(begin, end, lastNewline);
+    if(lastNewline) position.lineOffset = position.offset + (lastNewline - begin) + 1;
+    position.offset += end - begin;
+}
+void PushParser::feed(const char *data, size_t length) {
+    const char *p = data, *const end = data + length;
+    if(!carry.empty()) { //Finish the carried statement first.
+        const char *boundary = scanner.next(p, end);
+        if(boundary == end) {carry.append(p, end); return;}
+        carry.append(p, boundary+1); p = boundary+1;
+        parseStatement(carry.data(), carry.data() + carry.size());
+        carry.clear(); //Keeps its capacity for the next one.
+    }
+    while(p != end) {
+        const char *boundary = scanner.next(p, end);
+        if(boundary == end) {carry.assign(p, end); return;}
+        parseStatement(p, boundary+1); p = boundary+1;
+    }
+}
+void PushParser::finish() {
+    if(ByteScan::skipWhitespace(carry.data(), carry.data() + carry.size()) != carry.data() + carry.size())
+        parseStatement(carry.data(), carry.data() + carry.size());
+    carry.clear(); scanner.reset(); position = {0, 1, 0};
+}
+}
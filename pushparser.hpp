@@ -0,0 +1,49 @@
+#ifndef __PUSHPARSER__
+#define __PUSHPARSER__
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <memory>
+#include "error.hpp"
+#include "parser.hpp"
+#include "statementsplit.hpp"
+#include "validationcache.hpp"
+
+namespace SimpleSqlParser {
+//Validates input which arrives in pieces of any size (e.g. from a socket), one statement at a time: a statement
+//is parsed as soon as its ';' has been fed. Statements that lie within one piece are parsed in place; only
+//the unfinished statement at the end of a piece is kept (in the carry buffer) until the rest arrives, so memory
+//is bounded by the longest statement. Each statement is parsed on its own, so error recovery never carries
+//over into the next one. Locations are relative to the whole input.
+class PushParser {
+public:
+    //Called for each statement, after its diagnostics have gone to the DiagnosticSink. The text includes the
+    //';' and any whitespace or comments before it; it is only valid during the call. See
+    //Lexer::getStatementFingerprint for the fingerprint.
+    typedef std::function<void(std::string_view statement, size_t errors, uint64_t fingerprint)> StatementCallback;
+private:
+    Parser parser;
+    StatementCallback onStatement;
+    DiagnosticSink onDiagnostic;
+    StatementScanner scanner;
+    std::string carry; //Start of the unfinished statement
+    Lexer::Position position; //Of the next statement
+    ValidationCache *cache;
+
+    void parseStatement(const char *begin, const char *end);
+public:
+    PushParser(StatementCallback onStatement, DiagnosticSink onDiagnostic, 
+        std::shared_ptr<const CompiledGrammar> grammar = sharedSqlGrammar());
+
+    //Statements are looked up in cache (which may be shared with other PushParsers) and only parsed when
+    //they are not found; reported the same either way. nullptr (the default): each statement is parsed.
+    void setCache(ValidationCache *cache) noexcept {this->cache = cache;}
+    void feed(const char *data, size_t length);
+    //End of input: parses what is left after the last ';' (unless it is only whitespace) and gets ready for a new input.
+    void finish();
+};
+}
+
+#endif
@@ -0,0 +1,156 @@
+#include "sqlast.hpp"
+#include <cstring>
+
+namespace SimpleSqlParser {
+namespace {
+size_t findNonterminal(const CompiledGrammar &grammar, const char *name) noexcept {
+    for(size_t i = 0; i < grammar.nonterminalCount; i++) if(std::strcmp(grammar.nonterminalNames[i], name) == 0) return i;
+    return SqlAst::none;
+}
+}
+
+//SqlAst
+void SqlAst::clear() noexcept {
+    statements.clear(); names.clear();
+    constantTypes.clear(); intValues.clear(); numberValues.clear(); constantText.clear();
+    declarationNames.clear(); declarationTypes.clear(); declarationSizes.clear(); declarationScales.clear();
+    conditionOps.clear(); conditionOperands.clear(); operands.clear();
+}
+
+//SqlAstBuilder
+SqlAstBuilder::SqlAstBuilder(SqlAst &ast, const Parser &parser) : ast(ast), parser(parser), statement(nullptr), target(NO_TARGET) {
+    const CompiledGrammar &grammar = parser.getGrammar();
+    selectStmt = findNonterminal(grammar, "select_stmt"); insertStmt = findNonterminal(grammar, "insert_stmt");
+    createTableStmt = findNonterminal(grammar, "create_table_stmt"); fromStmt = findNonterminal(grammar, "from_stmt");
+    identifierList = findNonterminal(grammar, "identifier_list"); constantList = findNonterminal(grammar, "constant_list");
+    varDecl = findNonterminal(grammar, "var_decl"); primaryKeyDecl = findNonterminal(grammar, "primary_key_decl");
+    conditionExpr = findNonterminal(grammar, "condition_expr"); conditionTerm = findNonterminal(grammar, "condition_term");
+    conditionOp = findNonterminal(grammar, "condition_op");
+}
+void SqlAstBuilder::operator()(const ParseEvent &event) {
+    switch(event.kind) {
+    case ParseEvent::STATEMENT_START: {
+        const SqlAst::StatementKind kind = event.nonterminal == selectStmt ? SqlAst::SELECT_STATEMENT :
+            event.nonterminal == insertStmt ? SqlAst::INSERT_STATEMENT :
+            event.nonterminal == createTableStmt ? SqlAst::CREATE_TABLE_STATEMENT : SqlAst::EMPTY_STATEMENT;
+        const size_t names = ast.names.size();
+        ast.statements.push_back({kind, true, false, std::string_view(), {names, 0}, {names, 0}, {ast.constantTypes.size(), 0},
+            {ast.declarationNames.size(), 0}, {names, 0}, SqlAst::none, event.offset, event.location, 0});
+        statement = &ast.statements.back();
+        target = kind == SqlAst::SELECT_STATEMENT ? SELECT_LIST : kind == SqlAst::EMPTY_STATEMENT ? NO_TARGET : TABLE_NAME;
+        frames.clear(); pending.clear();
+        break;
+    }
+    case ParseEvent::STATEMENT_END:
+        if(statement) statement->fingerprint = event.fingerprint;
+        statement = nullptr; target = NO_TARGET;
+        break;
+    case ParseEvent::ENTER: {
+        const size_t nonterminal = event.nonterminal;
+        if(!statement) break;
+        if(nonterminal == conditionExpr || nonterminal == conditionTerm || nonterminal == conditionOp) {
+            frames.push_back({nonterminal, pending.size(), SqlAst::OR_CONDITION, false});
+            break;
+        }
+        if(!frames.empty()) break; //IN (constant_list) belongs to the condition.
+        //Lists are recursive, so only their first ENTER starts a range.
+        if(nonterminal == fromStmt) {target = FROM_LIST; statement->tables.begin = ast.names.size();}
+        else if(nonterminal == identifierList && statement->kind == SqlAst::INSERT_STATEMENT && target != INSERT_COLUMNS)
+            {target = INSERT_COLUMNS; statement->columns.begin = ast.names.size();}
+        else if(nonterminal == constantList && statement->kind == SqlAst::INSERT_STATEMENT && target != INSERT_VALUES)
+            {target = INSERT_VALUES; statement->values.begin = ast.constantTypes.size();}
+        else if(nonterminal == primaryKeyDecl) {target = PRIMARY_KEY; statement->primaryKey.begin = ast.names.size();}
+        else if(nonterminal == varDecl) {
+            target = DECLARATION; statement->declarations.count++;
+            ast.declarationNames.emplace_back(); ast.declarationTypes.push_back(NONE);
+            ast.declarationSizes.push_back(-1); ast.declarationScales.push_back(-1);
+        }
+        break;
+    }
+    case ParseEvent::EXIT:
+        if(!frames.empty() && frames.back().nonterminal == event.nonterminal) closeFrame();
+        break;
+    case ParseEvent::TOKEN: if(statement) token(event.token); break;
+    }
+}
+void SqlAstBuilder::token(TokenType ttype) {
+    const std::string_view lexeme = parser.getLexer().getCurrentLexemeView();
+    if(!frames.empty()) {
+        Frame &frame = frames.back();
+        switch(ttype) {
+        case IDENTIFIER: ast.names.push_back(lexeme); pending.push_back({SqlAst::Operand::IDENTIFIER_OPERAND, ast.names.size()-1}); break;
+        case INT_CONSTANT: case CHAR_CONSTANT: case NUMBER_CONSTANT: pending.push_back({SqlAst::Operand::CONSTANT_OPERAND, addConstant(ttype)}); break;
+        //The AND of BETWEEN comes after the operator and is skipped; other ANDs and ORs are in the term and expr frames.
+        case NOT: case LESSOP: case GREATEROP: case EQUALOP: case BETWEEN: case LIKE: case IN:
+            if(frame.nonterminal != conditionOp || frame.hasOp) break;
+            frame.hasOp = true;
+            frame.op = ttype == NOT ? SqlAst::NOT_CONDITION : ttype == LESSOP ? SqlAst::LESS_CONDITION : ttype == GREATEROP ? SqlAst::GREATER_CONDITION :
+                ttype == EQUALOP ? SqlAst::EQUAL_CONDITION : ttype == BETWEEN ? SqlAst::BETWEEN_CONDITION : ttype == LIKE ? SqlAst::LIKE_CONDITION : SqlAst::IN_CONDITION;
+            break;
+        default: break;
+        }
+        return;
+    }
+    switch(ttype) {
+    case STAROP: statement->star = true; break;
+    case IDENTIFIER:
+        switch(target) {
+        case TABLE_NAME: statement->table = lexeme; target = NO_TARGET; break;
+        case SELECT_LIST: case INSERT_COLUMNS: ast.names.push_back(lexeme); statement->columns.count++; break;
+        case FROM_LIST: ast.names.push_back(lexeme); statement->tables.count++; break;
+        case PRIMARY_KEY: ast.names.push_back(lexeme); statement->primaryKey.count++; break;
+        case DECLARATION: ast.declarationNames.back() = lexeme; break;
+        default: break;
+        }
+        break;
+    case INT: case CHAR: case NUMBER: if(target == DECLARATION) ast.declarationTypes.back() = ttype; break;
+    case INT_CONSTANT: case CHAR_CONSTANT: case NUMBER_CONSTANT:
+        if(target == INSERT_VALUES) {addConstant(ttype); statement->values.count++;}
+        else if(target == DECLARATION && ttype == INT_CONSTANT) {
+            int64_t &size = ast.declarationSizes.back();
+            (size < 0 ? size : ast.declarationScales.back()) = parser.getLexer().getCurrentIntValue();
+        }
+        break;
+    default: break;
+    }
+}
+size_t SqlAstBuilder::addConstant(TokenType ttype) {
+    const Lexer &lexer = parser.getLexer();
+    std::string_view text = lexer.getCurrentLexemeView();
+    if(ttype == CHAR_CONSTANT) text = text.substr(1, text.length() - 2); //Quotes
+    ast.constantTypes.push_back(ttype);
+    ast.intValues.push_back(ttype == INT_CONSTANT ? lexer.getCurrentIntValue() : 0);
+    ast.numberValues.push_back(ttype == CHAR_CONSTANT ? 0.0 : lexer.getCurrentNumberValue());
+    ast.constantText.push_back(text);
+    return ast.constantTypes.size() - 1;
+}
+size_t SqlAstBuilder::addCondition(SqlAst::ConditionOp op, const SqlAst::Operand *operands, size_t count) {
+    ast.conditionOps.push_back(op);
+    ast.conditionOperands.push_back({ast.operands.size(), count});
+    ast.operands.insert(ast.operands.end(), operands, operands + count);
+    return ast.conditionOps.size() - 1;
+}
+//Turns the frame's pending operands into one condition operand for the enclosing frame (or the WHERE clause).
+void SqlAstBuilder::closeFrame() {
+    const Frame frame = frames.back(); frames.pop_back();
+    const SqlAst::Operand *operands = pending.data() + frame.operandsBegin;
+    const size_t count = pending.size() - frame.operandsBegin;
+    SqlAst::Operand result{SqlAst::Operand::CONDITION_OPERAND, SqlAst::none};
+    if(frame.nonterminal == conditionOp) {
+        if(frame.hasOp) result.index = addCondition(frame.op, operands, count);
+        else if(count == 1) result = operands[0]; //(condition_expr)
+    }
+    else if(count > 0) { //condition_term: ANDs of its operands, condition_expr: ORs; both left associative.
+        const SqlAst::ConditionOp op = (frame.nonterminal == conditionTerm) ? SqlAst::AND_CONDITION : SqlAst::OR_CONDITION;
+        result = operands[0];
+        for(size_t i = 1; i < count; i++) {
+            const SqlAst::Operand pair[] = {result, operands[i]};
+            result = {SqlAst::Operand::CONDITION_OPERAND, addCondition(op, pair, 2)};
+        }
+    }
+    pending.resize(frame.operandsBegin);
+    if(result.index == SqlAst::none) return; //Syntax error
+    if(!frames.empty()) pending.push_back(result);
+    else if(result.kind == SqlAst::Operand::CONDITION_OPERAND) statement->condition = result.index;
+}
+}
@@ -0,0 +1,94 @@
+#ifndef __SQLAST__
+#define __SQLAST__
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "parser.hpp"
+
+namespace SimpleSqlParser {
+//What the statements of cfg.cpp say, in flat arrays shared by all statements: each Statement refers to ranges of
+//names, constants and declarations instead of owning nodes. Text is kept as slices of the parsed input, so it
+//is only valid while that input is (parse a buffer in place, e.g. a MappedFile, rather than a stream).
+struct SqlAst {
+    enum StatementKind : unsigned char {EMPTY_STATEMENT, SELECT_STATEMENT, INSERT_STATEMENT, CREATE_TABLE_STATEMENT};
+    enum ConditionOp : unsigned char {
+        OR_CONDITION, AND_CONDITION, NOT_CONDITION, //Operands are conditions.
+        LESS_CONDITION, GREATER_CONDITION, EQUAL_CONDITION, //a op b
+        BETWEEN_CONDITION, LIKE_CONDITION, IN_CONDITION //a BETWEEN b AND c, a LIKE b, a IN (b, ...)
+    };
+    static constexpr size_t none = SIZE_MAX;
+    struct Range {size_t begin, count;};
+    //Operand of a condition: an identifier (index into names), a constant or another condition.
+    struct Operand {
+        enum Kind : unsigned char {IDENTIFIER_OPERAND, CONSTANT_OPERAND, CONDITION_OPERAND} kind;
+        size_t index;
+    };
+    struct Statement {
+        StatementKind kind;
+        bool valid; //No error was reported within it; otherwise parts may be missing.
+        bool star; //SELECT *
+        std::string_view table; //INSERT, CREATE TABLE
+        Range columns; //names: the SELECT list or the INSERT column list
+        Range tables; //names: SELECT ... FROM
+        Range values; //constants: INSERT ... VALUES
+        Range declarations; //CREATE TABLE columns
+        Range primaryKey; //names: CREATE TABLE ... PRIMARY KEY
+        size_t condition; //SELECT ... WHERE: its root in conditions, or none
+        size_t offset; //Input offset of the first token
+        Lexer::Location location; //Of the first token
+        uint64_t fingerprint; //See Lexer::getStatementFingerprint
+    };
+
+    std::vector<Statement> statements;
+    std::vector<std::string_view> names;
+    //Constants: the same index into each array.
+    std::vector<TokenType> constantTypes; //INT_CONSTANT, CHAR_CONSTANT or NUMBER_CONSTANT
+    std::vector<int64_t> intValues; //INT_CONSTANT (saturated); 0 otherwise
+    std::vector<double> numberValues; //INT_CONSTANT and NUMBER_CONSTANT; 0 otherwise
+    std::vector<std::string_view> constantText; //The lexeme; for CHAR_CONSTANT without the quotes
+    //Column declarations of CREATE TABLE: the same index into each array.
+    std::vector<std::string_view> declarationNames;
+    std::vector<TokenType> declarationTypes; //INT, CHAR or NUMBER
+    std::vector<int64_t> declarationSizes, declarationScales; //-1 when not given
+    //Conditions: the same index into each array.
+    std::vector<ConditionOp> conditionOps;
+    std::vector<Range> conditionOperands; //into operands
+    std::vector<Operand> operands;
+
+    void clear() noexcept;
+};
+
+//Fills an SqlAst from the events of one Parser, while it parses: listen() is its ParseListener. Statements which
+//had errors are only marked as such if error() is called from the parser's DiagnosticSink.
+class SqlAstBuilder {
+    enum Target : unsigned char {NO_TARGET, TABLE_NAME, SELECT_LIST, FROM_LIST, INSERT_COLUMNS, INSERT_VALUES, DECLARATION, PRIMARY_KEY};
+    struct Frame { //A condition being built; its operands are pending from operandsBegin on.
+        size_t nonterminal, operandsBegin;
+        SqlAst::ConditionOp op;
+        bool hasOp;
+    };
+    SqlAst &ast;
+    const Parser &parser;
+    size_t selectStmt, insertStmt, createTableStmt, fromStmt, identifierList, constantList, varDecl, primaryKeyDecl;
+    size_t conditionExpr, conditionTerm, conditionOp;
+    SqlAst::Statement *statement; //Being parsed, or nullptr
+    Target target;
+    std::vector<Frame> frames;
+    std::vector<SqlAst::Operand> pending;
+
+    void token(TokenType);
+    size_t addConstant(TokenType);
+    size_t addCondition(SqlAst::ConditionOp, const SqlAst::Operand *operands, size_t count);
+    void closeFrame();
+public:
+    SqlAstBuilder(SqlAst &ast, const Parser &parser);
+
+    void operator()(const ParseEvent &);
+    ParseListener listen() {return [this](const ParseEvent &event) {(*this)(event);};}
+    void error() noexcept {if(statement) statement->valid = false;}
+};
+}
+
+#endif
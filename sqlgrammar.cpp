@@ -0,0 +1,12 @@
+#include "grammar.hpp"
+
+namespace SimpleSqlParser {
+namespace {
+#include "parsing_table.inc"
+}
+static_assert(sqlTokenCount == CompiledGrammar::tokenCount, "parsing_table.inc is out of date; rebuild it with tablegen.out");
+
+//Constant-initialized, so it is usable from any static initializer and costs nothing at startup.
+const CompiledGrammar sqlGrammar = {sqlParsingTable, sqlProductions, sqlSymbolPool, sqlNonterminalNames,
+    sqlNonterminalCount, sqlProductionCount, sqlSymbolCount};
+}
@@ -0,0 +1,53 @@
+#include "statementsplit.hpp"
+#include "bytescan.hpp"
+
+namespace SimpleSqlParser {
+//StatementScanner
+const char *StatementScanner::next(const char *p, const char *end) noexcept {
+    while(p != end) {
+        switch(state) {
+        case SLASH: state = (*p == '*') ? COMMENT : CODE; if(state == COMMENT) p++; break;
+        case COMMENT_STAR: state = (*p == '/') ? CODE : COMMENT; if(state == CODE) p++; break;
+        case COMMENT: {
+            const char *commentEnd = ByteScan::findCommentEnd(p, end);
+            if(commentEnd != end) {p = commentEnd+2; state = CODE; break;}
+            state = (end[-1] == '*') ? COMMENT_STAR : COMMENT; //A '/' may follow in the next piece.
+            return end;
+        }
+        case QUOTED: //Like Lexer::scanCharConstant, a constant ends at the next quote of either kind.
+            p = ByteScan::findEither(p, end, '\'', '\"');
+            if(p != end) {p++; state = CODE;}
+            break;
+        case CODE:
+            p = ByteScan::findAnyOf(p, end, ';', '\'', '\"', '/');
+            if(p == end || *p == ';') return p;
+            state = (*p == '/') ? SLASH : QUOTED; p++;
+            break;
+        }
+    }
+    return end;
+}
+
+std::vector<StatementChunk> splitStatements(const char *begin, const char *end, size_t chunkSize) {
+    std::vector<StatementChunk> chunks;
+    Lexer::Position position{0, 1, 0};
+    StatementScanner scanner;
+    const char *chunkBegin = begin;
+    while(chunkBegin != end) {
+        //Scan from the chunk's start: a boundary is only known to be top-level when every quote and
+        //comment before it has been seen.
+        const char *chunkEnd = chunkBegin;
+        do {
+            chunkEnd = scanner.next(chunkEnd, end);
+            if(chunkEnd != end) chunkEnd++;
+        } while(chunkEnd != end && (size_t)(chunkEnd - chunkBegin) < chunkSize);
+        chunks.push_back({chunkBegin, chunkEnd, position});
+        const char *lastNewline = nullptr;
+        position.lineNumber += ByteScan::countNewlines(chunkBegin, chunkEnd, lastNewline);
+        if(lastNewline) position.lineOffset = (lastNewline - begin) + 1;
+        position.offset = chunkEnd - begin;
+        chunkBegin = chunkEnd;
+    }
+    return chunks;
+}
+}
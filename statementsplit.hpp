@@ -0,0 +1,32 @@
+#ifndef __STATEMENTSPLIT__
+#define __STATEMENTSPLIT__
+
+#include <cstddef>
+#include <vector>
+#include "lexer.hpp"
+
+namespace SimpleSqlParser {
+//Slice of an input which ends right after a top-level ';' (or at the end of the input), so it holds whole
+//statements and can be parsed on its own. start locates it within the input for Lexer::reopen.
+struct StatementChunk {
+    const char *begin, *end;
+    Lexer::Position start;
+};
+//Finds top-level ';' (outside of CHAR_CONSTANTs and comments, as the lexer sees them) in input which may
+//arrive in pieces: a constant or comment left open at the end of one piece continues in the next.
+class StatementScanner {
+    enum State : unsigned char {CODE, SLASH, COMMENT, COMMENT_STAR, QUOTED}; //SLASH, COMMENT_STAR: piece ended on it
+    State state;
+public:
+    StatementScanner() noexcept : state(CODE) {}
+    //The first top-level ';' in [begin, end), which continues the input scanned so far; end if none.
+    const char *next(const char *begin, const char *end) noexcept;
+    void reset() noexcept {state = CODE;}
+};
+
+//Cuts [begin, end) into chunks of at least chunkSize bytes at statement boundaries: ';' outside of
+//CHAR_CONSTANTs and comments, found the way the lexer finds them. An input with no such ';' is one chunk.
+std::vector<StatementChunk> splitStatements(const char *begin, const char *end, size_t chunkSize);
+}
+
+#endif
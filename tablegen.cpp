@@ -0,0 +1,74 @@
+//Build step: runs the ParserGenerator phases on cfg.cpp once and writes the flattened tables
+//as constexpr arrays for sqlgrammar.cpp. Usage: tablegen.out <output file>
+#include <iostream>
+#include <fstream>
+#include "grammar.hpp"
+#include "error.hpp"
+
+using namespace std;
+using namespace SimpleSqlParser;
+
+namespace {
+void writeString(ostream &out, const char *str) {
+    out<<'"';
+    for(; *str; str++) {
+        if(*str == '"' || *str == '\\') out<<'\\';
+        out<<*str;
+    }
+    out<<'"';
+}
+void writeTables(ostream &out, const CompiledGrammar &grammar) {
+    out<<"//Generated by tablegen.out from cfg.cpp. Do not edit.\n";
+    out<<"constexpr size_t sqlTokenCount = "<<CompiledGrammar::tokenCount<<";\n";
+    out<<"constexpr size_t sqlNonterminalCount = "<<grammar.nonterminalCount<<", sqlProductionCount = "
+        <<grammar.productionCount<<", sqlSymbolCount = "<<grammar.symbolCount<<";\n";
+
+    out<<"\nconstexpr CompiledGrammar::Action sqlParsingTable[] = {";
+    for(size_t i = 0; i < grammar.nonterminalCount; i++) {
+        out<<"\n    ";
+        for(size_t k = 0; k < CompiledGrammar::tokenCount; k++) out<<grammar.action(i, (TokenType)k)<<", ";
+    }
+    out<<"\n};\n";
+
+    out<<"\nconstexpr CompiledGrammar::Production sqlProductions[] = {";
+    for(size_t i = 0; i < grammar.productionCount; i++) {
+        if(i % 8 == 0) out<<"\n    ";
+        out<<'{'<<grammar.productions[i].offset<<", "<<grammar.productions[i].length<<"}, ";
+    }
+    out<<"\n};\n";
+
+    out<<"\nconstexpr PackedSymbol sqlSymbolPool[] = {";
+    for(size_t i = 0; i < grammar.symbolCount; i++) {
+        if(i % 12 == 0) out<<"\n    ";
+        out<<'{'<<grammar.symbolPool[i].value<<"}, ";
+    }
+    out<<"\n};\n";
+
+    out<<"\nconstexpr const char *sqlNonterminalNames[] = {";
+    for(size_t i = 0; i < grammar.nonterminalCount; i++) {
+        out<<"\n    "; writeString(out, grammar.nonterminalNames[i]); out<<',';
+    }
+    out<<"\n};\n";
+}
+}
+
+int main(int argc, char *argv[]) {
+    if(argc != 2) {
+        cerr<<"Usage: "<<argv[0]<<" <output file>"<<endl;
+        return 2;
+    }
+    try {
+        RuntimeGrammar grammar;
+        ofstream out(argv[1]);
+        writeTables(out, grammar);
+        out.close();
+        if(!out) {
+            cerr<<"Could not write "<<argv[1]<<endl;
+            return 1;
+        }
+    } catch(const SyntaxError &ex) {
+        cerr<<ex.what()<<endl;
+        return 1;
+    }
+    return 0;
+}
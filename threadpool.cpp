@@ -0,0 +1,37 @@
+#include "threadpool.hpp"
+#include <thread>
+#include <vector>
+
+namespace SimpleSqlParser {
+//WorkStealingPool
+WorkStealingPool::WorkStealingPool(size_t workers) : queues(new WorkerQueue[workers ? workers : 1]), workers(workers ? workers : 1) {}
+bool WorkStealingPool::next(size_t worker, size_t &task) {
+    {
+        std::lock_guard<std::mutex> guard(queues[worker].lock);
+        if(!queues[worker].tasks.empty()) {
+            task = queues[worker].tasks.front(); queues[worker].tasks.pop_front();
+            return true;
+        }
+    }
+    for(size_t i = 1; i < workers; i++) { //Steal, starting with the next worker so victims are spread out.
+        WorkerQueue &victim = queues[(worker + i) % workers];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if(!victim.tasks.empty()) {
+            task = victim.tasks.back(); victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false; //Tasks are never added while running, so all queues are drained for good.
+}
+void WorkStealingPool::run(size_t count, const std::function<void(size_t, size_t)> &task) {
+    for(size_t i = 0; i < count; i++) queues[i % workers].tasks.push_back(i);
+    const auto work = [&](size_t worker) {
+        size_t index;
+        while(next(worker, index)) task(worker, index);
+    };
+    std::vector<std::thread> threads;
+    for(size_t worker = 1; worker < workers; worker++) threads.emplace_back(work, worker);
+    work(0);
+    for(auto &thread : threads) thread.join();
+}
+}
@@ -0,0 +1,35 @@
+#ifndef __THREADPOOL__
+#define __THREADPOOL__
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace SimpleSqlParser {
+//Runs tasks 0..count-1 on a fixed number of threads. Tasks are dealt out round-robin to per-worker queues;
+//a worker takes from the front of its own queue and, once that is empty, steals from the back of the
+//others', so a few long tasks (huge files) do not leave the remaining workers idle.
+class WorkStealingPool {
+    struct WorkerQueue {
+        std::mutex lock;
+        std::deque<size_t> tasks;
+    };
+    std::unique_ptr<WorkerQueue[]> queues;
+    size_t workers;
+
+    bool next(size_t worker, size_t &task);
+public:
+    WorkStealingPool(size_t workers);
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool&) = delete;
+
+    size_t size() const noexcept {return workers;}
+    //Blocks until every task is done. task(worker, index) is called on one of the pool's threads; the worker
+    //index lets tasks use per-thread state without locking. Worker 0 is the calling thread.
+    void run(size_t count, const std::function<void(size_t, size_t)> &task);
+};
+}
+
+#endif
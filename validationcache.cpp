@@ -0,0 +1,96 @@
+#include "validationcache.hpp"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace SimpleSqlParser {
+namespace {
+//FNV-1a, 8 bytes per multiply, finalized (splitmix64) so that the low bits, which pick the shard, are well mixed.
+uint64_t hashBytes(std::string_view bytes) noexcept {
+    constexpr uint64_t prime = 0x100000001b3ull;
+    uint64_t hash = 0xcbf29ce484222325ull, word;
+    const char *p = bytes.data(); size_t left = bytes.length();
+    for(; left >= 8; p += 8, left -= 8) {std::memcpy(&word, p, 8); hash = (hash ^ word) * prime;}
+    word = (uint64_t)bytes.length() << 56;
+    for(size_t i = 0; i < left; i++) word ^= (uint64_t)(unsigned char)p[i] << (8*i);
+    hash = (hash ^ word) * prime;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull; hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+    return hash ^ (hash >> 31);
+}
+}
+
+//ValidationCache
+ValidationCache::ValidationCache(size_t capacity, size_t shards) : hitCount(0), missCount(0) {
+    if(capacity == 0) capacity = 1;
+    shardCount = std::max<size_t>(1, std::min(shards, capacity));
+    shardCapacity = (capacity + shardCount - 1) / shardCount;
+    this->shards.reset(new Shard[shardCount]);
+}
+std::shared_ptr<const ValidationCache::Result> ValidationCache::find(std::string_view statement, uint64_t hash) {
+    Shard &shard = shardOf(hash);
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        const auto it = shard.index.find(hash);
+        if(it != shard.index.end()) {
+            Slot &slot = shard.slots[it->second];
+            if(slot.result->statement == statement) {
+                slot.referenced = true;
+                hitCount.fetch_add(1, std::memory_order_relaxed);
+                return slot.result;
+            }
+        }
+    }
+    missCount.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+std::shared_ptr<const ValidationCache::Result> ValidationCache::find(std::string_view statement) {
+    return find(statement, hashBytes(statement));
+}
+void ValidationCache::insert(uint64_t hash, std::shared_ptr<const Result> result) {
+    Shard &shard = shardOf(hash);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    const auto it = shard.index.find(hash);
+    if(it != shard.index.end()) {shard.slots[it->second].result = std::move(result); return;} //Raced, or a collision
+    size_t victim = shard.slots.size();
+    if(victim < shardCapacity) shard.slots.push_back({hash, nullptr, false});
+    else {
+        while(shard.slots[shard.hand].referenced) {
+            shard.slots[shard.hand].referenced = false; shard.hand = (shard.hand + 1) % shard.slots.size();
+        }
+        victim = shard.hand; shard.hand = (shard.hand + 1) % shard.slots.size();
+        shard.index.erase(shard.slots[victim].hash);
+    }
+    shard.slots[victim] = {hash, std::move(result), false}; //Evicted first unless it is used before the hand is back.
+    shard.index[hash] = victim;
+}
+std::shared_ptr<const ValidationCache::Result> ValidationCache::validate(Parser &parser, std::string_view statement) {
+    const uint64_t hash = hashBytes(statement);
+    if(std::shared_ptr<const Result> cached = find(statement, hash)) return cached;
+    const std::shared_ptr<Result> result = std::make_shared<Result>();
+    result->statement.assign(statement); //Parsed in place, so the lexemes of the diagnostics point into it.
+    parser.reopen(result->statement.data(), result->statement.data() + result->statement.size());
+    parser.parse([&result](const Diagnostic &diagnostic) {result->diagnostics.push_back(diagnostic);});
+    result->fingerprint = parser.getLexer().getStatementFingerprint();
+    insert(hash, result);
+    return result;
+}
+void ValidationCache::clear() {
+    for(size_t i = 0; i < shardCount; i++) {
+        std::lock_guard<std::mutex> guard(shards[i].lock);
+        shards[i].slots.clear(); shards[i].index.clear(); shards[i].hand = 0;
+    }
+    hitCount.store(0, std::memory_order_relaxed); missCount.store(0, std::memory_order_relaxed);
+}
+Lexer::Location ValidationCache::relocate(const Diagnostic &diagnostic, const Lexer::Position &start) noexcept {
+    Lexer::Location location = diagnostic.location;
+    if(location.lineNumber == 0) return location;
+    if(location.lineNumber == 1) { //Columns on the first line of the statement are shifted by where it starts.
+        const size_t shift = start.offset - start.lineOffset;
+        if(location.startColumnNumber > 0) location.startColumnNumber += shift;
+        //0 means none; a lexeme spanning lines ends on a later one.
+        if(location.endColumnNumber > 0 && diagnostic.lexeme.find('\n') == std::string_view::npos) location.endColumnNumber += shift;
+    }
+    location.lineNumber += start.lineNumber - 1;
+    return location;
+}
+}
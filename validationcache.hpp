@@ -0,0 +1,69 @@
+#ifndef __VALIDATIONCACHE__
+#define __VALIDATIONCACHE__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "error.hpp"
+#include "parser.hpp"
+
+namespace SimpleSqlParser {
+//Bounded cache of statement validation results, for input which repeats the same statements over and over (see
+//PushParser::setCache). Statements are looked up by a hash of their bytes and compared in full, so a hit costs
+//one pass over the text and neither the lexer nor the parser runs. Entries are spread over shards, each with
+//its own lock and CLOCK eviction (a referenced bit per entry, cleared as the hand sweeps past), so any number
+//of threads can share one cache.
+class ValidationCache {
+public:
+    //Immutable once cached; shared with the callers which found it, so eviction never invalidates it.
+    struct Result {
+        std::string statement;
+        uint64_t fingerprint; //See Lexer::getStatementFingerprint
+        //As parsed from the start of an input: see relocate(). The lexemes are slices of statement.
+        std::vector<Diagnostic> diagnostics;
+    };
+private:
+    struct Slot {
+        uint64_t hash;
+        std::shared_ptr<const Result> result;
+        bool referenced;
+    };
+    struct Shard {
+        std::mutex lock;
+        std::vector<Slot> slots;
+        std::unordered_map<uint64_t, size_t> index; //Hash to slot
+        size_t hand = 0;
+    };
+    std::unique_ptr<Shard[]> shards;
+    size_t shardCount, shardCapacity;
+    std::atomic<size_t> hitCount, missCount;
+
+    Shard &shardOf(uint64_t hash) noexcept {return shards[hash % shardCount];}
+    std::shared_ptr<const Result> find(std::string_view statement, uint64_t hash);
+    void insert(uint64_t hash, std::shared_ptr<const Result> result);
+public:
+    ValidationCache(size_t capacity, size_t shards = 16); //capacity: statements, at least 1.
+    ValidationCache(const ValidationCache&) = delete;
+    ValidationCache &operator=(const ValidationCache&) = delete;
+
+    std::shared_ptr<const Result> find(std::string_view statement);
+    //The cached result of statement, or the result of parsing it on its own with parser, which is then cached.
+    std::shared_ptr<const Result> validate(Parser &parser, std::string_view statement);
+    void clear();
+
+    size_t hits() const noexcept {return hitCount.load(std::memory_order_relaxed);}
+    size_t misses() const noexcept {return missCount.load(std::memory_order_relaxed);}
+    size_t capacity() const noexcept {return shardCount * shardCapacity;}
+
+    //Location of a cached diagnostic for the statement found at start within a larger input.
+    static Lexer::Location relocate(const Diagnostic &diagnostic, const Lexer::Position &start) noexcept;
+};
+}
+
+#endif